@@ -1,6 +1,7 @@
 #ifndef KIERKI_CLIENTCONTEXT_H
 #define KIERKI_CLIENTCONTEXT_H
 
+#include "common/ShmChannel.h"
 #include "common/common.h"
 #include "klient-common.h"
 
@@ -21,10 +22,19 @@ class ClientContext {
 
     bool isAutomatic;
 
+    // Shared memory transport, attached only if server agreed to it.
+    ShmChannel shmChannel;
+
   public:
     void createContext(const std::string &_clientAddressStr, const std::string &_serverAddressStr,
                        int _socketFd, bool _isAutomatic, TABLE_PLACE _tablePlace);
 
+    /// @brief Moves messages to shared memory of given memfd, socket is kept as a doorbell.
+    void attachShm(int memFd);
+
+    /// @brief Releases shared memory and closes socket.
+    void closeConnection();
+
     /// @brief Returns true if game can be finished.
     bool isGameFinished();
 
@@ -61,8 +71,16 @@ class ClientContext {
     /// @brief Client sends message to server.
     ssize_t sendMessageClient(std::string &message);
 
+    /// @brief Client receives message from server. Returns -1 with EAGAIN if there was only a
+    /// doorbell of shared memory to read.
+    ssize_t receiveMessageClient(char *buffer, size_t len);
+
     /// @brief Function initiates sending message to client and sets his status accordingly.
-    void initiateSending(std::string message);
+    /// Binary message, if given, is sent instead of encoding text one in binary protocol.
+    void initiateSending(std::string_view message, std::string_view binaryMessage = {});
+
+    /// @brief Switches to binary protocol, once IAM asking for it was written.
+    void setBinary();
 
     /// @brief Sets players cards.
     void setPlayerCards(std::vector<Card> cards);
@@ -127,8 +145,9 @@ class ClientContext {
     /// @brief Returns true if there is any message from server.
     bool hasServerMessage();
 
-    /// @brief Pops first server message.
-    std::string popFirstServerMessage();
+    /// @brief Pops first server message, in text form. Binary DEAL, TRICK or TAKEN is also read
+    /// straight into cardsMessage, text is then built only to display it.
+    std::string popFirstServerMessage(CardsMessage &cardsMessage);
 
     /// @brief Returns true if buffer has write message.
     bool hasWriteMessage();
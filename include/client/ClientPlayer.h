@@ -31,14 +31,17 @@ class ClientPlayer {
     /// @brief Function handles receiving busy.
     void receiveBusy(std::string serverMessage);
 
+    /// @brief Function handles receiving queue position.
+    void receiveQueue(std::string serverMessage);
+
     /// @brief Function handles receiving deal.
-    void receiveDeal(std::string serverMessage);
+    void receiveDeal(std::string serverMessage, const CardsMessage &cardsMessage);
 
     /// @brief Function handles receiving trick.
-    void receiveTrick(std::string serverMessage);
+    void receiveTrick(std::string serverMessage, const CardsMessage &cardsMessage);
 
     /// @brief Function handles receiving taken.
-    void receiveTaken(std::string serverMessage);
+    void receiveTaken(std::string serverMessage, const CardsMessage &cardsMessage);
 
     /// @brief Function handles receiving wrong.
     void receiveWrong(std::string serverMessage);
@@ -49,8 +52,12 @@ class ClientPlayer {
     /// @brief Function handles receiving total.
     void receiveTotal(std::string serverMessage);
 
-    /// @brief Handles message from server.
-    void handleMessageFromServer(std::string serverMessage);
+    /// @brief Handles message from server, cardsMessage is set if it was binary DEAL, TRICK or
+    /// TAKEN.
+    void handleMessageFromServer(std::string serverMessage, const CardsMessage &cardsMessage);
+
+    /// @brief Initiates sending TRICK with given card.
+    void sendTrick(Card &card);
 
     /// @brief Handles message from user.
     void handleMessageFromUser(const std::string &userMessage);
@@ -62,14 +69,20 @@ class ClientPlayer {
     int pollFromServer(char *buffer);
 
     /// @brief Client writes to server.
-    void writeToServer();
+    int writeToServer();
 
   public:
-    ClientPlayer(int _socketFd, const ClientArguments &_clientArguments,
+    /// @brief Creates player talking to server over given socket, or over shared memory of given
+    /// memfd if it is not ERROR_CODE.
+    ClientPlayer(int _socketFd, int _memFd, const ClientArguments &_clientArguments,
                  const std::string &_serverAddressStr, const std::string &_clientAddressStr);
 
-    /// @brief Client handles game.
-    void handleGame();
+    /// @brief Client handles game. Returns GAME_FINISHED, or GAME_DISCONNECTED if client plays
+    /// session and server closed connection before game finished.
+    int handleGame();
+
+    /// @brief Closes connection with server, together with its shared memory.
+    void closeConnection();
 };
 
 #endif // KIERKI_CLIENTPLAYER_H
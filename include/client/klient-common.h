@@ -33,6 +33,8 @@
 #include <sys/poll.h>
 
 #include "common/common.h"
+#include "common/frame.h"
+#include "common/rules.h"
 
 namespace ClientConstants {
 const int USER_INDEX = 0;
@@ -44,6 +46,10 @@ const std::string USER_CARDS = "cards\n";
 const std::string USER_TRICKS = "tricks\n";
 const int GAME_FINISHED = 1;
 const int GAME_NOT_FINISHED = 0;
+const int GAME_DISCONNECTED = 2;        // Server closed connection before game finished.
+const int SESSION_BACKOFF_MIN = 10;     // Milliseconds before first reconnect.
+const int SESSION_BACKOFF_MAX = 1000;   // Backoff doubles up to this many milliseconds.
+const int SESSION_MAX_ATTEMPTS = 50;    // Failed connections in a row before session gives up.
 } // namespace ClientConstants
 
 /// STRUCTS ///
@@ -51,15 +57,28 @@ const int GAME_NOT_FINISHED = 0;
 struct ClientArguments {
     char *host;
     char *port;
+    char *socketOptionsStr;
+    char *gamesStr;
     int aiFamily;
+    int games; // Games played in session, 0 means until process is killed.
+    SocketOptions socketOptions;
     TABLE_PLACE tablePlace;
     bool isAutomatic;
+    bool useShm;
+    bool binary;
+    bool session;
 
     ClientArguments() {
         host = nullptr;
         port = nullptr;
+        socketOptionsStr = nullptr;
+        gamesStr = nullptr;
         aiFamily = AF_UNSPEC;
+        games = 1;
         isAutomatic = false;
+        useShm = false;
+        binary = false;
+        session = false;
         tablePlace = TABLE_PLACE::UNDEFINED;
     }
 
@@ -102,9 +121,18 @@ struct ClientHand {
     int countResults = 0;
 
     std::vector<Card> clientCards;
+    uint64_t clientCardsMask = 0;
+
+    /// @brief Sets cards received in deal.
+    void setCards(std::vector<Card> &cards) {
+        clientCards = cards;
+        clientCardsMask = getCardsMask(cards);
+    }
 
     /// @brief Deletes card from vector in O(1) complexity.
     void deleteCard(int index) {
+        clientCardsMask &= ~(1ULL << getCardId(clientCards[index]));
+
         // Swap with last element.
         std::swap(clientCards[index], clientCards.back());
 
@@ -152,8 +180,10 @@ struct ClientHand {
 
 void displayCardsVector(std::vector<Card> &cards, bool endWithDot);
 
-std::string cardToTrick(Card &card, ClientHand clientHand);
+Frame cardToTrick(Card &card, ClientHand clientHand);
+
+Frame cardToBinaryTrick(Card &card, ClientHand clientHand);
 
-std::string strTrickClient(std::vector<Card> &currentCards, ClientHand clientHand);
+Card selectTrickCard(std::vector<Card> &currentCards, ClientHand clientHand);
 
 #endif // KIERKI_KLIENT_COMMON_H
@@ -13,16 +13,19 @@
 #include "common/common.h"
 #include "err/err.h"
 
-std::string getIamMessage(ClientArguments client_arguments);
+Frame getIamMessage(ClientArguments client_arguments);
 
 bool parseBusy(const std::string &message, ClientContext &clientContext);
 
-bool parseDeal(std::string message, ClientContext &clientContext);
+bool parseQueue(const std::string &message, ClientContext &clientContext);
 
-std::pair<bool, std::vector<Card>> parseTrickClient(std::string message,
+bool parseDeal(std::string message, const CardsMessage &deal, ClientContext &clientContext);
+
+std::pair<bool, std::vector<Card>> parseTrickClient(std::string message, const CardsMessage &trick,
                                                     ClientContext &clientContext);
 
-std::vector<Card> parseTaken(std::string message, ClientContext &clientContext);
+std::vector<Card> parseTaken(std::string message, const CardsMessage &taken,
+                             ClientContext &clientContext);
 
 bool parseWrong(std::string message, ClientContext &clientContext);
 
@@ -0,0 +1,148 @@
+#ifndef KIERKI_SHMCHANNEL_H
+#define KIERKI_SHMCHANNEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <atomic>
+#include <string>
+
+#include "common/common.h"
+
+namespace ShmConstants {
+const size_t RING_SIZE = 64 * 1024; // Power of two, room for everything queued for a player.
+const size_t CACHE_LINE = 64;
+const int SERVER_SPIN_MICROS = 50;  // Server also serves TCP clients, so it spins only briefly.
+const int CLIENT_SPIN_MICROS = 200; // Bot waits for three other players between its turns.
+const char DOORBELL = '!';
+const size_t DOORBELL_BUFFER = 64;
+const size_t NEGOTIATION_BUFFER = 64;
+} // namespace ShmConstants
+
+/// @brief Single producer single consumer ring of bytes in shared memory. Positions only grow and
+/// byte at position p lives at p modulo RING_SIZE, so ring is full when tail - head == RING_SIZE.
+struct ShmRing {
+    alignas(ShmConstants::CACHE_LINE) std::atomic<uint64_t> head{0}; // Moved by reader.
+    alignas(ShmConstants::CACHE_LINE) std::atomic<uint64_t> tail{0}; // Moved by writer.
+
+    // Reader sleeps in poll and has to be woken up by doorbell.
+    alignas(ShmConstants::CACHE_LINE) std::atomic<uint32_t> readerIdle{0};
+    // Writer found ring full and has to be woken up by doorbell once there is room.
+    std::atomic<uint32_t> writerWaiting{0};
+
+    alignas(ShmConstants::CACHE_LINE) char data[ShmConstants::RING_SIZE];
+
+    /// @brief Writes as many bytes as fit and returns their number, or ERROR_CODE if indexes
+    /// left by reader put more than RING_SIZE bytes in ring.
+    ssize_t push(const char *bytes, size_t len);
+
+    /// @brief Reads at most len bytes and returns their number, or ERROR_CODE if indexes left by
+    /// writer put more than RING_SIZE bytes in ring.
+    ssize_t pop(char *bytes, size_t len);
+
+    /// @brief Returns true if there is something to read.
+    bool hasData() const {
+        return tail.load(std::memory_order_acquire) != head.load(std::memory_order_relaxed);
+    }
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free and
+              std::atomic<uint32_t>::is_always_lock_free);
+
+/// @brief Region shared by server and a client, with one ring in each direction.
+struct ShmRegion {
+    ShmRing toClient;
+    ShmRing toServer;
+};
+
+/// @brief One side of shared memory transport. Protocol frames go through rings, and unix socket
+/// the transport was negotiated on stays open only as a doorbell: a side writes a byte to it
+/// when the other side sleeps in poll, and its end of file means the other side is gone.
+class ShmChannel {
+  private:
+    ShmRegion *region = nullptr;
+    int memFd = -1;
+    int socketFd = -1;
+    bool isServer = false;
+
+    // Poll reported socket itself, not only data in ring, so there are doorbells to drain.
+    bool socketReady = false;
+    // Outbound ring was full and other side was asked to ring once there is room.
+    bool outboundBlocked = false;
+
+    ShmRing &inbound() const {
+        return isServer ? region->toServer : region->toClient;
+    }
+
+    ShmRing &outbound() const {
+        return isServer ? region->toClient : region->toServer;
+    }
+
+    /// @brief Wakes up other side.
+    void ringDoorbell();
+
+  public:
+    /// @brief Creates region in new memfd for server side of connection on given socket.
+    bool create(int _socketFd);
+
+    /// @brief Maps region of given memfd for server side if isServer and client side otherwise.
+    bool attach(int _memFd, int _socketFd, bool _isServer);
+
+    /// @brief Unmaps region and closes memfd, socket belongs to caller.
+    void release();
+
+    bool isAttached() const {
+        return region != nullptr;
+    }
+
+    int getMemFd() const {
+        return memFd;
+    }
+
+    /// @brief Writes bytes to outbound ring like write to non blocking socket: returns number of
+    /// bytes written, -1 with EAGAIN if ring is full or -1 with EPROTO if other side broke ring.
+    ssize_t send(const char *data, size_t len);
+
+    /// @brief Reads bytes from inbound ring like read from non blocking socket: returns number of
+    /// bytes read, 0 if other side is gone, -1 with EAGAIN if there is nothing to read or -1 with
+    /// EPROTO if other side broke ring.
+    ssize_t receive(char *buffer, size_t len);
+
+    /// @brief Returns true if there is something to read.
+    bool hasInput() const {
+        return inbound().hasData();
+    }
+
+    /// @brief Spins for at most given time waiting for input, returns true if it arrived. Does not
+    /// spin if canSpin is false.
+    bool waitForInput(int spinMicros) const;
+
+    /// @brief Asks other side to ring before sleeping in poll. Returns false if input arrived
+    /// meanwhile and there is no point in sleeping.
+    bool setIdle();
+
+    /// @brief Tells other side that doorbell is no longer needed and remembers if poll reported
+    /// socket itself.
+    void setBusy(bool _socketReady);
+
+    /// @brief Returns true if outbound ring was full and other side has not made room yet.
+    bool isBlocked() const {
+        return outboundBlocked;
+    }
+
+    /// @brief Returns true once after other side made room in full outbound ring.
+    bool takeUnblocked();
+};
+
+/// @brief Returns true if waiting side may spin. On a single CPU the other side cannot run while
+/// we spin, so it is never worth it.
+bool canSpin();
+
+/// @brief Sends message with memfd attached over unix socket, returns false on failure.
+bool sendMemFd(int socketFd, const std::string &message, int memFd);
+
+/// @brief Receives message with memfd attached over unix socket and returns memfd or ERROR_CODE.
+int receiveMemFd(int socketFd, std::string &message);
+
+#endif // KIERKI_SHMCHANNEL_H
@@ -2,15 +2,18 @@
 #define KIERKI_COMMON_H
 
 #include <arpa/inet.h>
+#include <array>
 #include <chrono>
 #include <errno.h>
 #include <inttypes.h>
 #include <iomanip>
 #include <iostream>
 #include <limits.h>
+#include <list>
 #include <map>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <queue>
 #include <signal.h>
 #include <sstream>
@@ -20,9 +23,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <string>
+#include <string_view>
 #include <sys/poll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/un.h>
 #include <unistd.h>
 #include <vector>
 
@@ -47,9 +52,29 @@ const std::string WRONG = "WRONG";
 const std::string TAKEN = "TAKEN";
 const std::string SCORE = "SCORE";
 const std::string TOTAL = "TOTAL";
+const std::string QUEUE = "QUEUE";
+const std::string SPECTATE = "SPECTATE";
+const std::string SHM = "SHM";
 const std::string END_OF_MESSAGE = "\r\n";
 } // namespace Messages
 
+namespace BinaryConstants {
+const char IAM_FLAG = 'B';    // IAM<place>B asks for binary protocol from then on.
+const size_t HEADER_SIZE = 2; // Type and length of payload.
+const int VARINT_BITS = 7;    // Integers are written 7 bits per byte, lowest first.
+const uint8_t VARINT_MORE = 0x80;
+} // namespace BinaryConstants
+
+namespace SocketConstants {
+const std::string NO_DELAY = "nodelay";
+const std::string QUICK_ACK = "quickack";
+const std::string CORK = "cork";
+const std::string NONE = "none";
+const char SEPARATOR = ',';
+const std::string UNIX_PREFIX = "unix:"; // Host of unix domain socket, e.g. unix:/tmp/kierki.
+const char ABSTRACT_PREFIX = '@';         // Path of socket in abstract namespace, e.g. @kierki.
+} // namespace SocketConstants
+
 /// ENUMS ///
 
 enum class TABLE_PLACE { N = 0, E = 1, S = 2, W = 3, UNDEFINED = -1 };
@@ -76,21 +101,97 @@ enum class CLIENT_STATE {
     SENDING_DEAL,
     SENDING_TRICK,
     WAITING_FOR_TRICK,
-    SENDING_TAKEN,
-    SENDING_SCORE,
-    SENDING_TOTAL,
     WAITING_FOR_START,
     SENDING_WRONG,
     WAITING_FOR_IAM,
     SENDING_PREVIOUS,
+    IN_LOBBY,
+    SPECTATING,
     EMPTY_PLACE,
 };
 
+/// LOOKUP TABLES ///
+
+namespace CardConstants {
+const int DECK_SIZE = 52;
+const int LOWEST_VALUE = 2;
+
+/// @brief Text of a card, e.g. 10H, with its length.
+struct CardText {
+    char text[3];
+    uint8_t length;
+};
+
+constexpr char COLOR_CHARS[] = "CDHS";
+constexpr char VALUE_CHARS[] = "23456789?JQKA"; // 10 is written as two characters.
+constexpr char PLACE_CHARS[] = "NESW";
+constexpr char HAND_TYPE_CHARS[] = "??1234567";  // Indexed by hand type + 1.
+
+/// @brief Returns texts of all cards indexed by card id = color * 13 + value - 2.
+constexpr std::array<CardText, DECK_SIZE> makeCardTexts() {
+    std::array<CardText, DECK_SIZE> cardTexts{};
+    for (int id = 0; id < DECK_SIZE; id++) {
+        CardText &cardText = cardTexts[id];
+        int value = id % Constants::CARDS_NUMBER + LOWEST_VALUE;
+        if (value == 10) {
+            cardText.text[cardText.length++] = '1';
+            cardText.text[cardText.length++] = '0';
+        } else {
+            cardText.text[cardText.length++] = VALUE_CHARS[value - LOWEST_VALUE];
+        }
+        cardText.text[cardText.length++] = COLOR_CHARS[id / Constants::CARDS_NUMBER];
+    }
+    return cardTexts;
+}
+
+/// @brief Returns table mapping every character of chars to its position plus first and other
+/// characters to -1.
+constexpr std::array<int8_t, 256> makeCharTable(std::string_view chars, int first) {
+    std::array<int8_t, 256> charTable{};
+    charTable.fill(-1);
+    for (size_t i = 0; i < chars.size(); i++) {
+        charTable[static_cast<unsigned char>(chars[i])] = static_cast<int8_t>(first + i);
+    }
+    return charTable;
+}
+
+/// @brief Returns table mapping last but one character of card text to card value. The 0 of 10
+/// maps to 10, so every card is recognized by its last two characters.
+constexpr std::array<int8_t, 256> makeValueTable() {
+    std::array<int8_t, 256> valueTable = makeCharTable(VALUE_CHARS, LOWEST_VALUE);
+    valueTable['?'] = -1;
+    valueTable['0'] = 10;
+    return valueTable;
+}
+
+constexpr std::array<CardText, DECK_SIZE> CARD_TEXTS = makeCardTexts();
+constexpr std::array<int8_t, 256> COLOR_FROM_CHAR = makeCharTable(COLOR_CHARS, 0);
+constexpr std::array<int8_t, 256> VALUE_FROM_CHAR = makeValueTable();
+constexpr std::array<int8_t, 256> PLACE_FROM_CHAR = makeCharTable(PLACE_CHARS, 0);
+constexpr std::array<int8_t, 256> HAND_TYPE_FROM_CHAR = makeCharTable("1234567", 1);
+} // namespace CardConstants
+
 /// STRUCTS ///
 
+/// @brief Returns length of first binary message in buffer, or 0 if it is not complete yet.
+inline size_t binaryMessageLen(std::string_view buffer) {
+    if (buffer.size() < BinaryConstants::HEADER_SIZE) {
+        return 0;
+    }
+
+    size_t messageLen = BinaryConstants::HEADER_SIZE + static_cast<uint8_t>(buffer[1]);
+    return buffer.size() >= messageLen ? messageLen : 0;
+}
+
 struct ReadBuffer {
     std::string buffer;
 
+    // Bytes already searched for end of network message, so they are not scanned again.
+    size_t scanned = 0;
+
+    // Network messages are binary, each one says its own length.
+    bool binary = false;
+
     ReadBuffer() {
         buffer = "";
     }
@@ -100,20 +201,25 @@ struct ReadBuffer {
         buffer += message;
     }
 
-    /// @brief Returns length of a message ending with \ r\ n.
+    /// @brief Returns length of a message ending with \ r\ n, or of a binary message.
     int networkMessageLen() {
+        if (binary) {
+            return (int)binaryMessageLen(buffer);
+        }
+
         if (buffer.size() < 2) {
             return 0;
         }
 
         int messageLen = 0;
-        for (size_t index = 1; index < buffer.size(); index++) {
+        for (size_t index = std::max<size_t>(scanned, 1); index < buffer.size(); index++) {
             if (buffer[index - 1] == '\r' and buffer[index] == '\n') {
                 messageLen = index + 1;
                 break;
             }
         }
 
+        scanned = messageLen > 0 ? messageLen - 1 : buffer.size();
         return messageLen;
     }
 
@@ -122,10 +228,18 @@ struct ReadBuffer {
         int messageLen = networkMessageLen();
         std::string message = buffer.substr(0, messageLen);
         buffer = buffer.substr(messageLen);
+        scanned = 0;
 
         return message;
     }
 
+    /// @brief Empties buffer and releases its memory.
+    void reset() {
+        std::string().swap(buffer);
+        scanned = 0;
+        binary = false;
+    }
+
     /// @brief Returns length of a message ending with \ n.
     int userMessageLen() {
         if (buffer.empty()) {
@@ -153,17 +267,23 @@ struct ReadBuffer {
     }
 };
 
+/// @brief Queue of messages to write. List does not allocate while empty, so idle connections
+/// do not own any memory.
 struct WriteBuffer {
-    std::deque<std::string> messages;
+    std::list<std::string> messages;
     std::string currentMessage;
 
+    // Bytes of all queued messages that were not written yet.
+    size_t pendingBytes = 0;
+
     /// @brief Appends message to buffer.
-    void appendMessage(std::string message) {
-        if (messages.empty()) {
-            currentMessage = message;
-        }
+    void appendMessage(std::string_view message) {
+        messages.emplace_back(message);
+        pendingBytes += message.size();
 
-        messages.push_back(message);
+        if (messages.size() == 1) {
+            currentMessage = messages.front();
+        }
     }
 
     /// @brief Returns current message's 2 letter prefix.
@@ -187,6 +307,7 @@ struct WriteBuffer {
 
     /// @brief Returns true if wrote whole message and handles operations of shortening/popping.
     bool wroteWholeMessage(int bytesWrote) {
+        pendingBytes -= bytesWrote;
         if (bytesWrote == (int)messages.front().size()) {
             messages.pop_front();
             currentMessage.clear();
@@ -209,6 +330,13 @@ struct WriteBuffer {
     }
 };
 
+/// @brief Latency options of connected TCP socket, all of them are on unless user says otherwise.
+struct SocketOptions {
+    bool noDelay = true;  // Small messages leave at once instead of waiting for ACK (Nagle).
+    bool quickAck = true; // Peer's messages are ACKed at once instead of delayed.
+    bool cork = true;     // Messages queued for one connection leave in a single burst.
+};
+
 struct Card {
     CARD_COLOR cardColor;
     int cardValue;
@@ -222,49 +350,19 @@ struct Card {
     }
 
     /// @brief Returns card in a string format.
-    std::string toStr() {
-        std::string cardStr;
-        if (cardValue > 10) {
-            switch (cardValue) {
-            case 11:
-                cardStr = 'J';
-                break;
-            case 12:
-                cardStr = 'Q';
-                break;
-            case 13:
-                cardStr = 'K';
-                break;
-            case 14:
-                cardStr = 'A';
-                break;
-            default:
-                cardStr = ' ';
-            }
-        } else {
-            cardStr = std::to_string(cardValue);
-        }
+    std::string toStr() const;
+};
 
-        switch (cardColor) {
-        case CARD_COLOR::C:
-            cardStr += 'C';
-            break;
-        case CARD_COLOR::D:
-            cardStr += 'D';
-            break;
-        case CARD_COLOR::H:
-            cardStr += 'H';
-            break;
-        case CARD_COLOR::S:
-            cardStr += 'S';
-            break;
-        default:
-            cardStr += ' ';
-        }
+/// @brief Returns id of card.
+inline int getCardId(const Card &card) {
+    return static_cast<int>(card.cardColor) * Constants::CARDS_NUMBER + card.cardValue -
+           CardConstants::LOWEST_VALUE;
+}
 
-        return cardStr;
-    }
-};
+inline std::string Card::toStr() const {
+    const CardConstants::CardText &cardText = CardConstants::CARD_TEXTS[getCardId(*this)];
+    return std::string(cardText.text, cardText.length);
+}
 
 /// FUNCTIONS ///
 
@@ -284,15 +382,15 @@ bool canBeScore(const std::string &message);
 
 bool canBeTotal(const std::string &message);
 
+bool canBeQueue(const std::string &message);
+
 char tablePlaceToChar(int c);
 
 TABLE_PLACE charToTablePlace(const char &c);
 
 HAND_TYPE charToHandType(const char &c);
 
-bool setCardFromStr(Card &card, const std::string &str);
-
-std::string getCardsStr(std::vector<Card> &cards);
+bool setCardFromStr(Card &card, std::string_view str);
 
 std::pair<bool, std::vector<Card>> parseCardsVector(const std::string &message, size_t start,
                                                     size_t end);
@@ -301,6 +399,14 @@ void display(const std::string &sender, const std::string &receiver, const std::
 
 ssize_t sendMessage(int socketFd, const void *vptr, size_t n);
 
+ssize_t sendMessageMore(int socketFd, const void *vptr, size_t n);
+
+SocketOptions readSocketOptions(char const *string);
+
+void applySocketOptions(int socketFd, const SocketOptions &socketOptions);
+
+void rearmQuickAck(int socketFd, const SocketOptions &socketOptions);
+
 bool prefixEqual(const std::string &message, std::string expected);
 
 std::pair<int, int> getTrickNumber(std::string &message, int numberStart);
@@ -311,10 +417,18 @@ std::string getIpv4AndPortAddress(struct sockaddr_in addressIpv4);
 
 std::string getIpv6AndPortAddress(struct sockaddr_in6 addressIpv6);
 
+bool isUnixHost(const char *host);
+
+bool setUnixAddress(sockaddr_un &address, socklen_t &addressLen, const char *path);
+
+std::string getUnixPeerAddress(pid_t pid);
+
 void setServerAddressIpv4(uint16_t port, struct addrinfo *address_result,
                           struct sockaddr_in *serverAddress);
 
 void setServerAddressIpv6(uint16_t port, struct addrinfo *address_result,
                           struct sockaddr_in6 *serverAddress);
 
+uint64_t microsSince(std::chrono::steady_clock::time_point start);
+
 #endif // KIERKI_COMMON_H
@@ -0,0 +1,150 @@
+#ifndef KIERKI_FRAME_H
+#define KIERKI_FRAME_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <charconv>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "common/common.h"
+
+namespace FrameConstants {
+// SCORE and TOTAL are the longest messages: prefix, 4 places with 20 digit scores and ending.
+const size_t CAPACITY = 95;
+} // namespace FrameConstants
+
+/// Type byte of binary message. Payloads are:
+/// BUSY mask of taken places, QUEUE position, DEAL hand type, first player and card ids,
+/// TRICK trick number and card ids, WRONG trick number, TAKEN trick number, card ids and taker,
+/// SCORE and TOTAL place and score for every place.
+enum class BINARY_TYPE : uint8_t {
+    BUSY = 1,
+    QUEUE = 2,
+    DEAL = 3,
+    TRICK = 4,
+    WRONG = 5,
+    TAKEN = 6,
+    SCORE = 7,
+    TOTAL = 8,
+};
+
+/// @brief Protocol message with inline storage, so building it never allocates. Appends that
+/// would exceed capacity are cut, but no message of the protocol comes close to it.
+struct Frame {
+    char data[FrameConstants::CAPACITY];
+    uint8_t length = 0;
+
+    /// @brief Appends single character.
+    void append(char c) {
+        if (length < FrameConstants::CAPACITY) {
+            data[length++] = c;
+        }
+    }
+
+    /// @brief Appends string.
+    void append(std::string_view str) {
+        size_t len = std::min(str.size(), FrameConstants::CAPACITY - length);
+        memcpy(data + length, str.data(), len);
+        length += len;
+    }
+
+    /// @brief Appends number in decimal, written straight into inline storage.
+    void appendNumber(uint64_t number) {
+        auto [end, error] = std::to_chars(data + length, data + FrameConstants::CAPACITY, number);
+        if (error == std::errc()) {
+            length = static_cast<uint8_t>(end - data);
+        }
+    }
+
+    /// @brief Appends card in protocol form, e.g. 10H.
+    void appendCard(const Card &card) {
+        const CardConstants::CardText &cardText = CardConstants::CARD_TEXTS[getCardId(card)];
+        append(std::string_view(cardText.text, cardText.length));
+    }
+
+    /// @brief Appends cards one after another.
+    void appendCards(std::span<const Card> cards) {
+        for (const auto &card : cards) {
+            appendCard(card);
+        }
+    }
+
+    /// @brief Appends "\r\n".
+    void appendEnd() {
+        append(Messages::END_OF_MESSAGE);
+    }
+
+    /// @brief Returns message as a view of inline storage.
+    std::string_view view() const {
+        return {data, length};
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<Frame>);
+
+/// @brief DEAL, TRICK or TAKEN read straight from binary message. Place is first player of DEAL
+/// and taker of TAKEN, hand type is set only for DEAL.
+struct CardsMessage {
+    bool parsed = false;
+    BINARY_TYPE type = BINARY_TYPE::DEAL;
+    HAND_TYPE handType = HAND_TYPE::UNDEFINED;
+    TABLE_PLACE place = TABLE_PLACE::UNDEFINED;
+    int trickNumber = 0;
+    std::vector<Card> cards;
+};
+
+/// FUNCTIONS BUILDING PROTOCOL MESSAGES ///
+
+/// @brief Returns IAM, with binary flag if binary protocol is wanted.
+Frame getIamFrame(TABLE_PLACE place, bool binary = false);
+
+Frame getBusyFrame(uint32_t takenPlacesMask);
+
+Frame getQueueFrame(int position);
+
+Frame getDealFrame(HAND_TYPE handType, TABLE_PLACE firstPlayer, std::span<const Card> cards);
+
+Frame getTrickFrame(int trickNumber, std::span<const Card> cards);
+
+Frame getWrongFrame(int trickNumber);
+
+Frame getTakenFrame(int trickNumber, std::span<const Card> cards, TABLE_PLACE taker);
+
+Frame getResultsFrame(const std::string &which, const std::map<TABLE_PLACE, uint64_t> &scores);
+
+/// BINARY PROTOCOL ///
+
+Frame getBinaryDealFrame(HAND_TYPE handType, TABLE_PLACE firstPlayer, std::span<const Card> cards);
+
+Frame getBinaryTrickFrame(int trickNumber, std::span<const Card> cards);
+
+Frame getBinaryTakenFrame(int trickNumber, std::span<const Card> cards, TABLE_PLACE taker);
+
+/// @brief Reads binary DEAL, TRICK or TAKEN into cardsMessage and sets its parsed flag, which is
+/// left unset if message is of other type or malformed.
+bool readCardsMessage(std::string_view message, CardsMessage &cardsMessage);
+
+/// @brief Returns text form of message read by readCardsMessage.
+Frame getCardsMessageFrame(const CardsMessage &cardsMessage);
+
+/// @brief Returns binary form of a single text message, or empty frame if it is not a message
+/// that is ever sent after IAM.
+Frame encodeBinaryFrame(std::string_view message);
+
+/// @brief Returns text form of a single binary message, or empty frame if it is malformed.
+Frame decodeBinaryFrame(std::string_view message);
+
+/// @brief Encodes text messages written one after another, returns empty string if any of them
+/// cannot be encoded.
+std::string encodeBinary(std::string_view messages);
+
+/// @brief Decodes binary messages written one after another.
+std::string decodeBinary(std::string_view messages);
+
+#endif // KIERKI_FRAME_H
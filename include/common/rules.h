@@ -0,0 +1,148 @@
+#ifndef KIERKI_RULES_H
+#define KIERKI_RULES_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "common/common.h"
+
+/// Cards are identified by id = color * 13 + (value - 2), so a set of cards is a 52-bit mask.
+
+/// @brief Returns bit of card with given color and value.
+constexpr uint64_t cardBit(CARD_COLOR color, int value) {
+    return 1ULL << (static_cast<int>(color) * 13 + value - 2);
+}
+
+/// @brief Returns mask of all cards of given color.
+constexpr uint64_t colorMask(CARD_COLOR color) {
+    return 0x1fffULL << (static_cast<int>(color) * 13);
+}
+
+/// @brief Returns mask of all cards with given value.
+constexpr uint64_t valueMask(int value) {
+    return cardBit(CARD_COLOR::C, value) | cardBit(CARD_COLOR::D, value) |
+           cardBit(CARD_COLOR::H, value) | cardBit(CARD_COLOR::S, value);
+}
+
+namespace RulesConstants {
+const int MAX_CARD_PENALTIES = 4;
+
+/// @brief Points for every taken card in mask.
+struct CardPenalty {
+    uint64_t mask;
+    int points;
+};
+
+/// @brief Penalties of one hand type. Trick penalty is given for taking trick whose number has
+/// its bit set in trickMask.
+struct HandPenalties {
+    int perTrick;
+    CardPenalty cards[MAX_CARD_PENALTIES];
+    uint32_t trickMask;
+    int perMarkedTrick;
+};
+
+constexpr uint64_t HEARTS = colorMask(CARD_COLOR::H);
+constexpr uint64_t QUEENS = valueMask(static_cast<int>(CARD_VALUE::Q));
+constexpr uint64_t GUYS = valueMask(static_cast<int>(CARD_VALUE::J)) |
+                          valueMask(static_cast<int>(CARD_VALUE::K));
+constexpr uint64_t KING_OF_HEARTS = cardBit(CARD_COLOR::H, static_cast<int>(CARD_VALUE::K));
+constexpr uint32_t SEVENTH_AND_LAST = (1U << 7) | (1U << Constants::TRICK_NUMBER);
+
+/// @brief Penalties indexed by HAND_TYPE, bandit is the sum of all other hand types.
+constexpr HandPenalties HAND_PENALTIES[] = {
+    // Unused, HAND_TYPE values start at 1
+    {0, {}, 0, 0},
+    // DEFAULT
+    {1, {}, 0, 0},
+    // HEART
+    {0, {{HEARTS, 1}}, 0, 0},
+    // QUEEN
+    {0, {{QUEENS, 5}}, 0, 0},
+    // GUYS
+    {0, {{GUYS, 2}}, 0, 0},
+    // HEART_KING
+    {0, {{KING_OF_HEARTS, 18}}, 0, 0},
+    // SEVEN_N_LAST
+    {0, {}, SEVENTH_AND_LAST, 10},
+    // BANDIT
+    {1, {{HEARTS, 1}, {QUEENS, 5}, {GUYS, 2}, {KING_OF_HEARTS, 18}}, SEVENTH_AND_LAST, 10},
+};
+} // namespace RulesConstants
+
+/// @brief Returns penalty for taking cards in given mask in trick with given number.
+constexpr int getTrickPenalty(HAND_TYPE handType, uint64_t takenMask, int trickNumber) {
+    int handTypeInt = static_cast<int>(handType);
+    if (handTypeInt < 0 or handTypeInt > static_cast<int>(HAND_TYPE::BANDIT)) {
+        return 0;
+    }
+
+    const RulesConstants::HandPenalties &penalties = RulesConstants::HAND_PENALTIES[handTypeInt];
+
+    int points = penalties.perTrick;
+    for (const auto &cardPenalty : penalties.cards) {
+        points += __builtin_popcountll(takenMask & cardPenalty.mask) * cardPenalty.points;
+    }
+    points += ((penalties.trickMask >> trickNumber) & 1) * penalties.perMarkedTrick;
+
+    return points;
+}
+
+/// @brief Returns mask of given cards.
+inline uint64_t getCardsMask(const std::vector<Card> &cards) {
+    uint64_t mask = 0;
+    for (const auto &card : cards) {
+        mask |= 1ULL << getCardId(card);
+    }
+    return mask;
+}
+
+/// @brief Returns card with given id.
+inline Card getCardFromId(int cardId) {
+    Card card = Card();
+    card.cardColor = static_cast<CARD_COLOR>(cardId / 13);
+    card.cardValue = cardId % 13 + 2;
+    return card;
+}
+
+namespace RulesConstants {
+/// @brief Masks of colors indexed by led card id + 13 divided by 13, so that -1 (nothing led)
+/// maps to empty mask.
+constexpr uint64_t LED_COLOR_MASKS[] = {0, colorMask(CARD_COLOR::C), colorMask(CARD_COLOR::D),
+                                        colorMask(CARD_COLOR::H), colorMask(CARD_COLOR::S)};
+} // namespace RulesConstants
+
+/// @brief Returns mask of cards from hand that can be placed on card with given id (-1 if player
+/// leads). Led color has to be followed if possible, otherwise any card can be placed.
+constexpr uint64_t getLegalMoves(uint64_t handMask, int ledCardId) {
+    uint64_t following = handMask & RulesConstants::LED_COLOR_MASKS[(ledCardId + 13) / 13];
+    return following | (handMask & (0ULL - static_cast<uint64_t>(following == 0)));
+}
+
+/// @brief Returns four card ids in play order packed into bytes, first placed card in lowest one.
+inline uint32_t packTrick(const std::vector<Card> &placedCards) {
+    uint32_t packedIds = 0;
+    for (int i = 0; i < Constants::PLAYERS_NUMBER; i++) {
+        packedIds |= static_cast<uint32_t>(getCardId(placedCards[i])) << (8 * i);
+    }
+    return packedIds;
+}
+
+/// @brief Returns offset of trick winner from the player who led. Each card gets a key made of
+/// following led color, its value and reversed position, and the highest key wins.
+constexpr int getTrickWinner(uint32_t packedIds) {
+    uint32_t ledColor = (packedIds & 0xff) / 13;
+
+    uint32_t bestKey = 0;
+    for (uint32_t i = 0; i < Constants::PLAYERS_NUMBER; i++) {
+        uint32_t cardId = (packedIds >> (8 * i)) & 0xff;
+        uint32_t following = static_cast<uint32_t>(cardId / 13 == ledColor);
+        uint32_t key = (following << 6) | ((cardId % 13) << 2) | (3 - i);
+
+        bestKey ^= (bestKey ^ key) & (0U - static_cast<uint32_t>(key > bestKey));
+    }
+
+    return 3 - static_cast<int>(bestKey & 3);
+}
+
+#endif // KIERKI_RULES_H
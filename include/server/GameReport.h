@@ -0,0 +1,92 @@
+#ifndef KIERKI_GAMEREPORT_H
+#define KIERKI_GAMEREPORT_H
+
+#include <chrono>
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "server/StateSerializer.h"
+#include "server/serwer-common.h"
+#include "common/common.h"
+
+/// @brief Time spent on a single trick, split by seat.
+struct TrickTiming {
+    int hand = 0;
+    int trick = 0;
+    uint64_t startMicros = 0; // Since start of the game.
+    uint64_t durationMicros = 0;
+    uint64_t stallMicros = 0;
+    uint64_t thinkMicros[Constants::PLAYERS_NUMBER] = {};
+    int wrong[Constants::PLAYERS_NUMBER] = {};
+    int timeouts[Constants::PLAYERS_NUMBER] = {};
+    int reconnects[Constants::PLAYERS_NUMBER] = {};
+    bool botCard[Constants::PLAYERS_NUMBER] = {};
+
+    /// @brief Returns think time of all seats.
+    uint64_t getThinkMicros() const;
+
+    /// @brief Returns time of trick that is neither players' think time nor stall.
+    uint64_t getProcessingMicros() const;
+};
+
+/// @brief Splits wall-clock time of a game into think time of players, stall waiting for players
+/// who left and the rest spent by server on sending and handling messages. Tricks are recorded
+/// in memory and report of every finished game is appended to a file.
+class GameReport {
+  private:
+    bool enabled = false;
+    std::string path;
+    std::ofstream reportFile;
+
+    int gamesReported = 0;
+    bool started = false;
+    std::chrono::steady_clock::time_point gameStartedAt;
+    std::chrono::steady_clock::time_point trickStartedAt;
+
+    TrickTiming current;
+    std::vector<TrickTiming> tricks;
+
+    /// @brief Appends report of recorded tricks to file.
+    void writeReport();
+
+  public:
+    /// @brief Opens report file at given path for appending, nothing is recorded without it.
+    void openReport(const char *reportPath);
+
+    /// @brief Starts recording game, first trick starts now.
+    void startGame();
+
+    /// @brief Adds time between TRICK sent to seat and its card, timeout or disconnection.
+    void addThink(int seat, uint64_t micros);
+
+    /// @brief Adds time table waited for players who left to come back.
+    void addStall(uint64_t micros);
+
+    /// @brief Counts WRONG sent to seat.
+    void addWrong(int seat);
+
+    /// @brief Counts TRICK of seat that timed out.
+    void addTimeout(int seat);
+
+    /// @brief Counts player who took seat in a started game.
+    void addReconnect(int seat);
+
+    /// @brief Marks card of seat as placed by server.
+    void addBotCard(int seat);
+
+    /// @brief Finishes current trick, next one starts now.
+    void finishTrick(int hand, int trick);
+
+    /// @brief Writes report of game and forgets its tricks.
+    void finishGame();
+
+    /// @brief Writes tricks recorded so far.
+    void serialize(StateWriter &stateWriter);
+
+    /// @brief Restores tricks written by serialize.
+    void deserialize(StateReader &stateReader);
+};
+
+#endif // KIERKI_GAMEREPORT_H
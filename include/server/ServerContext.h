@@ -3,34 +3,129 @@
 
 #include <unistd.h>
 
+#include <algorithm>
+#include <map>
+#include <memory>
+
+#include "common/ShmChannel.h"
+#include "common/frame.h"
+#include "server/StateSerializer.h"
 #include "server/serwer-common.h"
 #include "common/common.h"
 
+/// @brief State of a single connection, kept together so that a slot is one allocation unit.
+struct Connection {
+    ReadBuffer readBuffer;
+    WriteBuffer writeBuffer;
+    sockaddr_in6 clientAddress;
+    std::string clientAddressStr;
+    std::string serverAddressStr;
+    int socketTimeout = 0;
+    int waitingPosition = Constants::ERROR_CODE; // In waitingIndexes, if server waits for it.
+    bool overWriteLimit = false;
+    CLIENT_STATE clientState = CLIENT_STATE::WAITING_FOR_START;
+};
+
+namespace ConnectionConstants {
+// Memory of a slot: connection state, poll descriptor and spectator cursor. Idle connection owns
+// no heap memory on top of it.
+const size_t SLOT_BYTES = sizeof(Connection) + sizeof(pollfd) + sizeof(size_t);
+const size_t SLOT_BUDGET = 256;
+} // namespace ConnectionConstants
+
+static_assert(ConnectionConstants::SLOT_BYTES <= ConnectionConstants::SLOT_BUDGET);
+
+/// @brief Connections are kept in a table that grows by slabs of SLAB_SIZE slots. Slabs are never
+/// moved, and free slots of clients who are not players are kept on a free list.
 class ServerContext {
   private:
     int baseTimeout;
-    std::vector<int> socketTimeouts;
-    std::vector<bool> waitingFor;
-    std::vector<std::string> clientAddressStr;
-    std::vector<std::string> serverAddressStr;
-
     int socketFd;
-    pollfd pollDescriptors[ServerConstants::CONNECTIONS];
+    int unixSocketFd;
+
+    std::vector<pollfd> pollDescriptors;
+    std::vector<std::unique_ptr<Connection[]>> slabs;
+    std::vector<int> freeSlots;
 
     std::vector<short> storedPollEvents;
     std::vector<int> storedIndexes;
-    std::vector<ReadBuffer> readBuffers;
-    std::vector<WriteBuffer> writeBuffers;
-    std::vector<CLIENT_STATE> clientStates;
+
+    /// @brief Returns connection at given index.
+    Connection &connectionAt(int index) {
+        return slabs[index / ServerConstants::SLAB_SIZE][index % ServerConstants::SLAB_SIZE];
+    }
+
+    /// @brief Appends slab of empty slots to the table.
+    void addSlab();
+
+    /// @brief Puts every free slot of clients who are not players on the free list.
+    void rebuildFreeSlots();
+
+    // Connections that poll reported in last iteration, in ascending order.
+    std::vector<int> readyToRead;
+    std::vector<int> readyToWrite;
+
+    // Connections server waits for, only their timeouts run, in no particular order.
+    std::vector<int> waitingIndexes;
+
+    /// @brief Returns true if server waits for connection at given index.
+    bool isWaitingFor(int index) {
+        return connectionAt(index).waitingPosition != Constants::ERROR_CODE;
+    }
+
+    // Bytes a connection may buffer in each direction before it is evicted.
+    size_t readLimit = ServerConstants::DEFAULT_READ_LIMIT;
+    size_t writeLimit = ServerConstants::DEFAULT_WRITE_LIMIT;
+
+    // Latency options applied to every accepted connection.
+    SocketOptions socketOptions;
+
+    // Shared memory transport of bots on this host, by index of their connection.
+    std::map<int, ShmChannel> shmChannels;
+
+    // Connections that went over write limit, they are evicted by caller at a safe point.
+    std::vector<int> overWriteLimit;
+
+    /// @brief Marks connection at given index if messages queued for it exceed write limit.
+    void checkWriteLimit(int index);
+
+    /// @brief Returns client address at given index, formatting it on first use.
+    const std::string &getClientAddressStrAt(int index);
+
+    /// @brief Returns server address at given index, formatting it on first use.
+    const std::string &getServerAddressStrAt(int index);
+
+    /// @brief Spins briefly for input from shared memory and asks its writers to ring before poll
+    /// sleeps. Returns timeout poll should use.
+    int prepareShmForPoll(int startingPoint, int timeout);
+
+    /// @brief Marks connections with input in shared memory or room again in it as ready, and
+    /// returns number of descriptors that became ready this way.
+    int collectShmReady(int startingPoint);
 
   public:
-    void createContext(int _baseTimeout, int _socketFd);
+    void createContext(int _baseTimeout, int _socketFd, int _unixSocketFd, int _metricsFd);
+
+    /// @brief Sets how many bytes a connection may buffer for reading and for writing.
+    void setConnectionLimits(size_t _readLimit, size_t _writeLimit);
+
+    /// @brief Sets latency options of accepted connections.
+    void setSocketOptions(const SocketOptions &_socketOptions);
+
+    /// @brief Returns true if messages queued for a connection are written in a single burst.
+    bool corksWrites();
 
     /// FUNCTIONS RESPONSIBLE FOR POLL DESCRIPTORS. ///
 
     /// @brief Function initializes poll structures.
     void initializePollStructures();
 
+    /// @brief Returns free slot for client who is not a player or ERROR_CODE if table is full.
+    int reserveSlot();
+
+    /// @brief Returns number of slots in the table.
+    int getSlotsNumber();
+
     /// @brief Function resets poll descriptor at given index.
     void resetPollDescriptor(int index);
 
@@ -52,19 +147,37 @@ class ServerContext {
     /// @brief Functions sets events to check if server can write at given index.
     void pollSetWrite(int index);
 
+    /// @brief Function reserves descriptor at given index for fd with given events.
+    void setPollDescriptor(int index, int fd, short events);
+
+    /// @brief Function sets events of descriptor at given index.
+    void setPollEvents(int index, short events);
+
     /// FUNCTIONS RESPONSIBLE FOR POLL. ///
 
     /// @brief Functions returns minimal timeout or -1 if server is not waiting for any client.
     int getPollTimeout(int startingPoint);
 
-    /// @brief Function resets revents starting from startingPoint for non empty descriptors.
+    /// @brief Function resets revents starting from startingPoint for non empty descriptors. Only
+    /// fixed descriptors and connections reported by last poll can have them set.
     void resetRevents(int startingPoint);
 
     /// @brief Functions subtracts time from socket timeouts for clients server is waiting for.
     void revaluateTimeouts(int duration, int startingPoint);
 
-    /// @brief Function for executing poll.
-    int executePoll(bool includePlayers);
+    /// @brief Collects connections with input or room for output, stopping after readyCount
+    /// descriptors with events were seen.
+    void collectReady(int startingPoint, int readyCount);
+
+    /// @brief Function for executing poll, waiting at most timeoutLimit milliseconds unless it is
+    /// -1.
+    int executePoll(bool includePlayers, int timeoutLimit = -1);
+
+    /// @brief Returns connections that had input in last poll.
+    const std::vector<int> &getReadyToRead();
+
+    /// @brief Returns connections that could be written to in last poll.
+    const std::vector<int> &getReadyToWrite();
 
     /// FUNCTIONS FOR HANDLING TIMEOUTS. ///
 
@@ -80,13 +193,15 @@ class ServerContext {
     /// @brief Function resets timeout for socket at given index.
     void resetTimeout(int index);
 
+    /// @brief Puts indexes from firstIndex on of connections that timed out to given vector.
+    void collectTimedOut(int firstIndex, std::vector<int> &indexes);
+
     /// FUNCTIONS FOR HANDLING SERVER_CONNECTIONS. ///
 
-    /// @brief Function accepts connection from new client. If game is full then sets status to
-    /// sending busy and puts busy message in buffer, otherwise sets status to waiting for IAM
-    /// and starts timeout.
-    void acceptConnection(int index, int clientFd, bool gameFull, const std::string &clientIP,
-                          const std::string &serverIp);
+    /// @brief Function accepts connection from new client, sets status to waiting for IAM and
+    /// starts timeout. Addresses are formatted only when a message is displayed. Client of unix
+    /// socket has AF_UNIX as address family.
+    void acceptConnection(int index, int clientFd, const sockaddr_in6 &clientAddress);
 
     /// @brief Functions moves client to players place.
     void movePlayer(int from, int to);
@@ -102,8 +217,24 @@ class ServerContext {
     /// @brief Function displays message from server to client at given index.
     void displayMessageFromServer(int index, const std::string &message);
 
-    /// @brief Function sends message to descriptor at given index.
-    ssize_t sendMessageServer(int index, std::string &message);
+    /// @brief Function sends message to descriptor at given index. If it is sent in a burst,
+    /// corking is on and more messages are queued behind it, kernel holds it back until the last
+    /// one of the burst.
+    ssize_t sendMessageServer(int index, std::string &message, bool inBurst = false);
+
+    /// @brief Function sends len bytes starting at data to descriptor at given index.
+    ssize_t sendBytesServer(int index, const char *data, size_t len);
+
+    /// @brief Reads from descriptor at given index, or from its shared memory if it has one.
+    /// Returns -1 with EAGAIN if there was only a doorbell to read.
+    ssize_t receiveAt(int index, char *buffer, size_t len);
+
+    /// @brief Moves connection at given index to shared memory and sends memfd to client. Returns
+    /// false if it is not a unix socket connection or transport could not be set up.
+    bool upgradeToShm(int index, const std::string &reply);
+
+    /// @brief Turns quick ACK on again after reading from descriptor at given index.
+    void rearmQuickAckAt(int index);
 
     /// FUNCTIONS FOR HANDLING BUFFERS. ///
 
@@ -113,8 +244,22 @@ class ServerContext {
     /// @brief If write buffer is empty then it sets descriptor events to read only.
     void checkIfEmpty(int index);
 
+    /// @brief Returns true if something is still queued for client at given index.
+    bool hasPendingWriteAt(int index);
+
+    /// @brief Returns true if reading readLen more bytes would exceed read limit at given index.
+    bool exceedsReadLimit(int index, size_t readLen);
+
+    /// @brief Moves indexes of connections over write limit to given vector.
+    void takeOverWriteLimit(std::vector<int> &indexes);
+
+    /// @brief Returns true if connection at given index is still over write limit.
+    bool isOverWriteLimit(int index);
+
     /// @brief Function initiates sending message to client and sets his status accordingly.
-    void initiateSending(int index, std::string message, CLIENT_STATE clientState);
+    /// Binary message, if given, is sent instead of encoding text one for binary clients.
+    void initiateSending(int index, std::string_view message, CLIENT_STATE clientState,
+                         std::string_view binaryMessage = {});
 
     /// @brief Functions returns true if we have sent previous to everyone.
     bool hasEveryoneReceivedPreviousTaken();
@@ -128,29 +273,50 @@ class ServerContext {
     /// @brief Restoring events after sending previous deal and taken to new player.
     void restoreEventsExceptIndexes();
 
+    /// @brief Switches connection at given index to binary protocol, both for what is still in
+    /// its read buffer and for everything written from now on.
+    void setBinaryAt(int index);
+
+    /// @brief Returns true if connection at given index uses binary protocol.
+    bool isBinaryAt(int index);
+
     /// @brief Sets client state at given index.
     void setClientStateAt(int index, CLIENT_STATE clientState);
 
     /// @brief Returns client state at given index.
     CLIENT_STATE getClientStateAt(int index);
 
-    /// @brief Returns current write message at given index.
+    /// @brief Returns current write message at given index, in text form.
     std::string getCurrentWriteMessageAt(int index);
 
     /// @brief Returns first write message at given index.
     std::string getFirstWriteMessageAt(int index);
 
-    ///@brief Appends message to write buffer at given index.
-    void appendMessageToWriteAt(int index, std::string message);
+    ///@brief Appends message to write buffer at given index, encoding it for binary clients.
+    void appendMessageToWriteAt(int index, std::string_view message);
+
+    ///@brief Appends message to write buffer at given index, binary clients get binaryMessage.
+    void appendMessageToWriteAt(int index, std::string_view message,
+                                std::string_view binaryMessage);
 
     /// @brief Calls wroteWholeMessage function from write buffer.
     bool wroteWholeMessageAt(int index, int sentLen);
 
-    /// @brief Pops and returns first message at given index.
-    std::string popFirstReadMessageAt(int index);
+    /// @brief Pops and returns first message at given index, in text form. DEAL, TRICK or TAKEN
+    /// of binary client is also read straight into cardsMessage, text is then built only to log.
+    std::string popFirstReadMessageAt(int index, CardsMessage &cardsMessage);
 
     ///@brief Appends message to read buffer at given index.
     void appendMessageToReadAt(int index, std::string message);
+
+    /// FUNCTIONS FOR HANDING OVER CONTEXT TO NEW PROCESS. ///
+
+    /// @brief Writes listening sockets, every player and client who is not a player with its
+    /// descriptor and state. Metrics connections are not handed over.
+    void serialize(StateWriter &stateWriter);
+
+    /// @brief Restores connections and their state written by serialize.
+    void deserialize(StateReader &stateReader);
 };
 
 #endif // KIERKI_SERVERCONTEXT_H
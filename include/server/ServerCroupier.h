@@ -13,7 +13,13 @@
 #include <fstream>
 #include <sstream>
 
+#include "server/GameReport.h"
 #include "server/ServerContext.h"
+#include "server/ServerJournal.h"
+#include "server/ServerMetrics.h"
+#include "server/ServerUpgrade.h"
+#include "server/SpectatorFeed.h"
+#include "server/TableFlow.h"
 #include "server/serwer-common.h"
 #include "server/serwer-communicator.h"
 #include "common/common.h"
@@ -22,14 +28,68 @@
 class ServerCroupier {
   private:
     ServerStatus serverStatus;
+
+    // Daemon starts games parsed from these files in rotation, without restarting the server.
+    bool daemonEnabled;
+    std::vector<ServerStatus> games;
+    size_t currentGame = 0;
     ServerContext serverContext;
+    MetricsEndpoint metricsEndpoint;
+
+    bool lobbyEnabled;
+    ServerLobby lobby;
+
+    bool spectatorsEnabled;
+    SpectatorFeed spectatorFeed;
+
+    ServerJournal journal;
+    const char *journalPath;
+
+    // Where time of every game went, appended to a file once it ends.
+    GameReport report;
+
+    const char *upgradePath;
+    bool handedOver = false;
+
+    std::chrono::steady_clock::time_point trickSentAt[Constants::PLAYERS_NUMBER];
+
+    // TRICK sent again after timeout or rejoin is not published to spectators twice.
+    bool trickPublished = false;
+
+    // Seats of players who left during game are played by server after grace period, given in
+    // seconds with -b and kept here in milliseconds, unless it is -1. Player coming back takes
+    // seat over again.
+    int botGrace;
+    std::map<int, std::chrono::steady_clock::time_point> vacantSince;
+    bool botSeats[Constants::PLAYERS_NUMBER] = {};
+
+    // Flow of the game is a coroutine parked in tableWait between events.
+    TableWait tableWait;
+    TableFlow tableFlow;
+
+    // Seats that received bytes in this iteration, only their buffers are handled.
+    std::vector<int> playersWithInput;
+    std::vector<int> handledPlayers;
+
+    // Seats received bytes while the table was paused, their buffers are handled on resume.
+    bool pausedPlayerInput = false;
+
+    // Connections over write limit that are being closed in this iteration.
+    std::vector<int> evicted;
+
+    // Clients who did not send IAM in time and are being closed in this iteration.
+    std::vector<int> timedOut;
 
     /// HELPER FUNCTIONS ///
 
     /// @brief Function for closing connection with a player.
     void closeConnectionWithPlayer(int index);
 
-    /// @brief Function returns free slot if found and ERROR_CODE otherwise.
+    /// @brief Function for closing connection with a client who is not a player.
+    void closeConnectionWithNonPlayer(int index);
+
+    /// @brief Function returns free slot, growing connection table if needed, and ERROR_CODE
+    /// if table is full.
     int findFreeSlot();
 
     /// HELPER FUNCTIONS FOR SENDING MESSAGES ///
@@ -43,9 +103,6 @@ class ServerCroupier {
     /// @brief Function to be called before sending deal.
     void prepareSendingDeal(int index, CLIENT_STATE clientState);
 
-    /// @brief Function to be called after sending deal.
-    void afterSendingDeal(int index);
-
     /// @brief Function to be called before sending trick to client at given index.
     void prepareSendingTrick(int index);
 
@@ -55,27 +112,76 @@ class ServerCroupier {
     /// @brief Function to be called before sending taken to clients.
     void prepareSendingTaken();
 
-    /// @brief Function to be called after sending taken message.
-    void afterSendingTaken(int index);
+    /// @brief Function publishes deals of current hand to spectators.
+    void publishDeals();
 
-    /// @brief Function to be called after sending deal/taken message.
+    /// @brief Function to be called after rejoining player received deal and taken messages.
     void afterSendingPrevious(int index);
 
     /// @brief Function to be called before sending score.
     void prepareSendingScore(int index);
 
-    /// @brief Function to be called after sending score.
-    void afterSendingScore(int index);
-
     /// @brief Function to be called before sending total.
     void prepareSendingTotal(int index);
 
-    /// @brief Function to be called after sending total.
-    void afterSendingTotal(int index);
-
     /// @brief Function starts to close waiting clients because of game start.
     void startClosingWaiting();
 
+    /// FUNCTIONS FOR TABLE FLOW ///
+
+    /// @brief Plays game from the point serverStatus is at, so it can be started again after
+    /// hot upgrade or recovery from journal.
+    TableFlow playTable();
+
+    /// @brief Waits until every place is taken and rejoining players caught up.
+    SeatAwaiter tableReady();
+
+    /// @brief Waits until everything queued for seat is written. Resumes with LEFT if seat is
+    /// empty or it gets disconnected.
+    SeatAwaiter sent(int seat);
+
+    /// @brief Waits until seat places a valid card, times out or gets disconnected.
+    SeatAwaiter trickFrom(int seat);
+
+    /// @brief Returns true if every place is taken, rejoining players caught up and at least one
+    /// place is not played by server.
+    bool isTableReady();
+
+    /// @brief Resumes flow waiting for table if it is ready.
+    void resumeIfTableReady();
+
+    /// @brief Starts next game of daemon once table is empty, keeping sockets, parsed deals and
+    /// buffers of the server.
+    void startNextGame();
+
+    /// FUNCTIONS FOR PLAYING SEATS OF DISCONNECTED PLAYERS ///
+
+    /// @brief Returns number of seats played by server.
+    int getBotSeatsNumber();
+
+    /// @brief Returns milliseconds until first vacant seat is taken over by server, or -1.
+    int getBotTimeout();
+
+    /// @brief Server takes over seats vacant for longer than grace period.
+    void handleVacantSeats();
+
+    /// @brief Places card for seat played by server.
+    void playForBot(int seat);
+
+    /// FUNCTIONS FOR HANDLING LOBBY ///
+
+    /// @brief Parks client at given index in lobby until given place is free.
+    void parkInLobby(int index, TABLE_PLACE place);
+
+    /// @brief Sends new positions to clients waiting for place starting from given position.
+    void notifyLobby(TABLE_PLACE place, int fromPosition);
+
+    /// @brief Seats first client waiting for place at given index if there is one.
+    void seatFromLobby(int index);
+
+    /// @brief Sends busy to everyone in lobby because no place will be freed.
+    void closeLobby();
+
     /// FUNCTIONS FOR HANDLING MESSAGES FROM CLIENTS ///
 
     /// @brief Returns client place on success and TABLE_PLACE::UNDEFINED otherwise.
@@ -84,21 +190,36 @@ class ServerCroupier {
     /// @brief Handles messages from buffer and sets ClientStatus accordingly.
     void handleNonPlayerMessage(int index);
 
+    /// @brief Moves client at given index to his place at the table.
+    void seatPlayer(int index, TABLE_PLACE clientPlace);
+
     /// @brief Handles message when not expecting it.
     void handleNonCurrentMessage(int index);
 
     /// @brief Function to be called after receiving trick.
     void afterReceivingTrick(int index);
 
+    /// @brief Moves game on after card of given seat was placed.
+    void afterPlacingCard(int index);
+
     /// @brief Handles message from player when we waited for TRICK.
     void handleCurrentMessage(int index);
 
-    /// @brief We handle players buffer.
+    /// @brief We handle buffers of players who sent something in this iteration.
     void handlePlayersBuffer();
 
     /// FUNCTION FOR ACCEPTING NEW CONNECTION
 
-    /// @brief Function handles new connection.
+    /// @brief Function writes busy to client without registering it in poll and closes it.
+    void rejectConnection(int clientFd, const sockaddr_in6 &clientAddress);
+
+    /// @brief Function registers accepted client or rejects it if game is full.
+    void acceptNewConnection(int clientFd, const sockaddr_in6 &clientAddress);
+
+    /// @brief Accepts all pending connections of listening socket at given index.
+    void acceptPending(int acceptIndex);
+
+    /// @brief Function accepts all pending connections over TCP and unix socket.
     void handleNewConnection();
 
     /// FUNCTION FOR HANDLING TIMEOUT ///
@@ -111,26 +232,46 @@ class ServerCroupier {
     /// @brief Handling read of non player.
     void readFromNonPlayer(int index, char *buffer);
 
-    /// @brief Function reads messages from non players.
+    /// @brief Closes connections whose queued messages exceed write limit.
+    void evictOverWriteLimit();
+
+    /// @brief Function reads messages from non players that poll reported.
     void readFromNonPlayers(char *buffer);
 
-    /// @brief Function reads messages from players.
+    /// @brief Function reads messages from players that poll reported.
     void readFromPlayers(char *buffer);
 
-    /// FUNCTIONS FOR SENDING MESSAGES ///
+    /// FUNCTIONS FOR HOT UPGRADE ///
 
-    /// @brief Returns true if server sent busy message.
-    bool serverSentBusy(int index, ssize_t sentLen);
+    /// @brief Writes whole game state.
+    void serialize(StateWriter &stateWriter);
 
-    /// @brief Function writes to non players.
+    /// @brief Restores game state written by serialize.
+    void deserialize(StateReader &stateReader);
+
+    /// @brief Receives game from previous process and returns moment it stopped serving.
+    std::chrono::steady_clock::time_point takeOverGame(int upgradeFd);
+
+    /// @brief Hands game over to new process connected to upgrade socket.
+    void handleUpgrade();
+
+    /// FUNCTIONS FOR SENDING MESSAGES ///
+
+    /// @brief Function writes to non players that poll reported.
     void writeToNonPlayers();
 
-    /// @brief Function writes to players if poll is including them.
+    /// @brief Writes messages queued for player at given index, with corking all of them in one
+    /// burst. Returns true if player received everything queued for it.
+    bool writeQueuedToPlayer(int index);
+
+    /// @brief Function writes to players that poll reported if poll is including them.
     void writeToPlayers();
 
     /// CONSTRUCTOR FUNCTION ///
   public:
-    ServerCroupier(int socketFd, ServerArguments &serverArguments, ServerStatus &serverStatus);
+    /// @brief If upgradeFd is valid game is taken over from previous process connected to it.
+    ServerCroupier(int socketFd, int unixSocketFd, int metricsFd, int upgradeFd,
+                   ServerArguments &serverArguments, std::vector<ServerStatus> &games);
 
     /// @brief Server handles game.
     void handleGame();
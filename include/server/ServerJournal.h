@@ -0,0 +1,72 @@
+#ifndef KIERKI_SERVERJOURNAL_H
+#define KIERKI_SERVERJOURNAL_H
+
+#include <stdint.h>
+#include <string>
+
+#include "server/serwer-common.h"
+#include "common/common.h"
+
+namespace JournalConstants {
+const std::string SNAPSHOT_SUFFIX = ".snapshot";
+const std::string TEMPORARY_SUFFIX = ".tmp";
+const uint32_t SNAPSHOT_MAGIC = 0x4b534e50; // "KSNP"
+const size_t HEADER_SIZE = 8;
+const size_t RECORD_SIZE = 4;
+const size_t SNAPSHOT_SIZE = 4 + HEADER_SIZE + 4 + Constants::PLAYERS_NUMBER * 8;
+} // namespace JournalConstants
+
+/// @brief Makes game survive server crash. Every accepted card is appended to write-ahead log
+/// as a 4 byte record: hand (2 bytes), place and card. Records are group-committed once per
+/// event loop iteration. At the end of every hand scores are written to a snapshot and the log
+/// is truncated, so recovery replays at most one hand.
+///
+/// Log and snapshot start with fingerprint of game file, so they are never applied to a different
+/// game.
+class ServerJournal {
+  private:
+    bool enabled = false;
+
+    std::string logPath;
+    std::string snapshotPath;
+    int logFd = Constants::ERROR_CODE;
+
+    uint64_t fingerprint = 0;
+    std::string pending;
+
+    /// @brief Returns fingerprint of hands read from game file.
+    static uint64_t getFingerprint(ServerStatus &serverStatus);
+
+    /// @brief Applies snapshot to server status, returns false if there is no valid snapshot.
+    bool readSnapshot(ServerStatus &serverStatus);
+
+    /// @brief Replays card plays of current hand from write-ahead log.
+    void replayLog(ServerStatus &serverStatus);
+
+    /// @brief Replays single card play, returns false if it is not valid in current state.
+    static bool replayCard(ServerStatus &serverStatus, TABLE_PLACE place, Card card);
+
+    /// @brief Truncates log and writes its header.
+    void resetLog();
+
+  public:
+    /// @brief Returns true if journal at given path was written for given game.
+    static bool isJournalOf(const char *path, ServerStatus &serverStatus);
+
+    /// @brief Opens journal at given path and if asked recovers server status from it.
+    void openJournal(const char *path, ServerStatus &serverStatus, bool recover);
+
+    /// @brief Queues accepted card play of given place.
+    void logCard(int currentHand, TABLE_PLACE place, Card card);
+
+    /// @brief Writes queued records and flushes them to disk.
+    void commit();
+
+    /// @brief Writes snapshot of finished hands and truncates log.
+    void writeSnapshot(ServerStatus &serverStatus);
+
+    /// @brief Removes journal files after game has ended.
+    void finish();
+};
+
+#endif // KIERKI_SERVERJOURNAL_H
@@ -0,0 +1,108 @@
+#ifndef KIERKI_SERVERMETRICS_H
+#define KIERKI_SERVERMETRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "server/serwer-common.h"
+#include "common/common.h"
+
+class ServerContext;
+
+namespace MetricsConstants {
+const int MAX_BUCKETS = 16;
+const size_t MAX_REQUEST_SIZE = 4096;
+const std::string HTTP_END_OF_HEADERS = "\r\n\r\n";
+const std::string METRICS_PATH = "/metrics";
+} // namespace MetricsConstants
+
+enum class METRIC_COUNTER {
+    CONNECTIONS_ACCEPTED,
+    BUSY_SENT,
+    IAM_TIMEOUTS,
+    TRICK_TIMEOUTS,
+    WRONG_SENT,
+    BYTES_IN,
+    BYTES_OUT,
+    LIMIT_EVICTIONS,
+    SHM_CONNECTIONS,
+    GAMES_PLAYED,
+    BOT_SUBSTITUTIONS,
+    BOT_CARDS,
+    COUNT
+};
+
+enum class METRIC_GAUGE { ACTIVE_TABLES, CONNECTION_TABLE_BYTES, COUNT };
+
+enum class METRIC_HISTOGRAM { THINK_TIME, LOOP_ITERATION_TIME, GAME_RESTART_TIME, COUNT };
+
+/// @brief Metrics of a single thread. Every field is updated with relaxed atomics only by the
+/// owning thread and read by the thread rendering metrics.
+struct MetricsShard {
+    std::atomic<uint64_t> counters[static_cast<int>(METRIC_COUNTER::COUNT)]{};
+    std::atomic<int64_t> gauges[static_cast<int>(METRIC_GAUGE::COUNT)]{};
+    std::atomic<uint64_t> buckets[static_cast<int>(METRIC_HISTOGRAM::COUNT)]
+                                 [MetricsConstants::MAX_BUCKETS + 1]{};
+    std::atomic<uint64_t> histogramSums[static_cast<int>(METRIC_HISTOGRAM::COUNT)]{};
+    std::atomic<uint64_t> histogramCounts[static_cast<int>(METRIC_HISTOGRAM::COUNT)]{};
+};
+
+/// FUNCTIONS ///
+
+/// @brief Increases counter by value.
+void metricsIncrement(METRIC_COUNTER counter, uint64_t value = 1);
+
+/// @brief Adds delta to gauge.
+void metricsAddGauge(METRIC_GAUGE gauge, int64_t delta);
+
+/// @brief Records observation given in microseconds.
+void metricsObserve(METRIC_HISTOGRAM histogram, uint64_t micros);
+
+/// @brief Returns all metrics in Prometheus text exposition format.
+std::string getMetricsText();
+
+/// @brief Serves metrics over HTTP from descriptors reserved in server context.
+class MetricsEndpoint {
+  private:
+    bool enabled = false;
+
+    std::vector<std::string> requests;
+    std::vector<std::string> responses;
+    std::vector<size_t> responseOffsets;
+
+    // Order in which connection in every slot was accepted, oldest one is evicted when all slots
+    // are taken.
+    std::vector<uint64_t> acceptOrder;
+    uint64_t acceptedCount = 0;
+
+    /// @brief Returns slot of descriptor at given index.
+    static int slotOf(int index);
+
+    /// @brief Closes http connection at given index.
+    void closeHttpConnection(int index, ServerContext &serverContext);
+
+    /// @brief Returns index of free slot, evicting connection accepted longest ago if there is
+    /// none.
+    int takeSlot(ServerContext &serverContext);
+
+    /// @brief Accepts pending http connections.
+    void acceptHttpConnections(ServerContext &serverContext);
+
+    /// @brief Reads request at given index and prepares response once it is complete.
+    void readRequest(int index, ServerContext &serverContext);
+
+    /// @brief Writes response at given index and closes connection once it is sent.
+    void writeResponse(int index, ServerContext &serverContext);
+
+  public:
+    /// @brief Enables endpoint if listening descriptor was set in server context.
+    void createEndpoint(ServerContext &serverContext);
+
+    /// @brief Handles http connections after poll.
+    void handleEndpoint(ServerContext &serverContext);
+};
+
+#endif // KIERKI_SERVERMETRICS_H
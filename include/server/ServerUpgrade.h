@@ -0,0 +1,54 @@
+#ifndef KIERKI_SERVERUPGRADE_H
+#define KIERKI_SERVERUPGRADE_H
+
+#include <string>
+#include <vector>
+
+#include "server/StateSerializer.h"
+#include "server/serwer-common.h"
+#include "common/common.h"
+
+namespace UpgradeConstants {
+const int MAX_FDS_PER_MESSAGE = 250;
+const size_t HEADER_SIZE = 16;
+const char ACK = 'A';
+const int HANDOVER_TIMEOUT = 1000; // Milliseconds a single send or receive of handover may take.
+} // namespace UpgradeConstants
+
+/// FUNCTIONS FOR SERIALIZING GAME STATE ///
+
+void writeServerStatus(StateWriter &stateWriter, ServerStatus &serverStatus);
+
+void readServerStatus(StateReader &stateReader, ServerStatus &serverStatus);
+
+void writeServerLobby(StateWriter &stateWriter, ServerLobby &lobby);
+
+void readServerLobby(StateReader &stateReader, ServerLobby &lobby);
+
+/// FUNCTIONS FOR HANDING OVER STATE ///
+
+/// @brief Returns non blocking unix socket listening for new server process at given path.
+int createUpgradeSocket(const char *path);
+
+/// @brief Returns socket connected to server running at given path or ERROR_CODE if there is
+/// no such server.
+int connectToRunningServer(const char *path);
+
+/// @brief Bounds every send and receive on upgrade socket by HANDOVER_TIMEOUT, so that a stuck
+/// process on the other side cannot stop the game. Returns false on failure.
+bool setHandoverTimeout(int upgradeFd);
+
+/// @brief Sends state and its descriptors, returns false on failure.
+bool sendState(int upgradeFd, const StateWriter &stateWriter);
+
+/// @brief Receives state and its descriptors, returns false on failure.
+bool receiveState(int upgradeFd, std::string &state, std::vector<int> &fds);
+
+/// @brief Confirms that new process has taken over the game, or that running server has
+/// received that confirmation in time and stops.
+bool sendAck(int upgradeFd);
+
+/// @brief Returns true if the other process confirmed, see sendAck.
+bool receiveAck(int upgradeFd);
+
+#endif // KIERKI_SERVERUPGRADE_H
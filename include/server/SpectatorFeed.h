@@ -0,0 +1,57 @@
+#ifndef KIERKI_SPECTATORFEED_H
+#define KIERKI_SPECTATORFEED_H
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include "server/ServerContext.h"
+#include "server/serwer-common.h"
+#include "common/common.h"
+
+namespace SpectatorConstants {
+const size_t MAX_LAG = 64 * 1024;
+} // namespace SpectatorConstants
+
+/// @brief Streams table events to spectators. Every event is appended once to a shared log and
+/// each spectator only keeps an offset of the first byte it has not received yet.
+class SpectatorFeed {
+  private:
+    std::string events;
+    size_t handStart = 0;
+
+    /// @brief Indexed by connection index, grows together with connection table.
+    std::vector<size_t> cursors;
+    std::vector<int> spectators;
+
+    /// @brief Closes connection with spectator at given index.
+    void dropSpectator(int index, ServerContext &serverContext);
+
+  public:
+    /// @brief Registers client at given index as spectator of current hand.
+    void addSpectator(int index, ServerContext &serverContext);
+
+    /// @brief Forgets spectator at given index, connection has to be closed by caller.
+    void removeSpectator(int index);
+
+    /// @brief Marks start of a new hand, late spectators start reading from here.
+    void startHand();
+
+    /// @brief Marks start of a new game and drops events every spectator has already received,
+    /// so that log of a daemon holds at most what the slowest spectator lags behind.
+    void startGame();
+
+    /// @brief Appends event to log, wakes spectators up and drops those lagging too far behind.
+    void appendEvent(std::string_view message, ServerContext &serverContext);
+
+    /// @brief Writes pending events to spectator at given index.
+    void writeToSpectator(int index, ServerContext &serverContext);
+
+    /// @brief Writes event log and spectators' cursors.
+    void serialize(StateWriter &stateWriter);
+
+    /// @brief Restores event log and spectators' cursors written by serialize.
+    void deserialize(StateReader &stateReader);
+};
+
+#endif // KIERKI_SPECTATORFEED_H
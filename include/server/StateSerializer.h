@@ -0,0 +1,83 @@
+#ifndef KIERKI_STATESERIALIZER_H
+#define KIERKI_STATESERIALIZER_H
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "common/common.h"
+
+/// FUNCTIONS ///
+
+/// @brief Appends value on given number of bytes in little endian order.
+void appendBytes(std::string &buffer, uint64_t value, int bytes);
+
+/// @brief Reads value stored on given number of bytes in little endian order.
+uint64_t readBytes(const char *data, int bytes);
+
+/// @brief Serializes server state to bytes. Descriptors are not written to the buffer, they are
+/// collected separately and only their position is stored.
+class StateWriter {
+  private:
+    std::string buffer;
+    std::vector<int> fds;
+
+  public:
+    void writeInt(int64_t value);
+
+    void writeString(const std::string &value);
+
+    void writeCards(const std::vector<Card> &cards);
+
+    /// @brief Writes descriptor, negative descriptors are written as absent.
+    void writeFd(int fd);
+
+    template <typename V> void writePlaceMap(const std::map<TABLE_PLACE, V> &placeMap) {
+        writeInt(placeMap.size());
+        for (const auto &[place, value] : placeMap) {
+            writeInt(static_cast<int>(place));
+            writeInt(value);
+        }
+    }
+
+    const std::string &getBuffer() const;
+
+    const std::vector<int> &getFds() const;
+};
+
+/// @brief Reads state written by StateWriter. Reading past the end marks reader as failed and
+/// returns zero values.
+class StateReader {
+  private:
+    std::string buffer;
+    std::vector<int> fds;
+    size_t offset = 0;
+    bool failed = false;
+
+  public:
+    StateReader(std::string buffer, std::vector<int> fds);
+
+    int64_t readInt();
+
+    std::string readString();
+
+    std::vector<Card> readCards();
+
+    /// @brief Returns received descriptor or ERROR_CODE if it was absent.
+    int readFd();
+
+    template <typename V> void readPlaceMap(std::map<TABLE_PLACE, V> &placeMap) {
+        placeMap.clear();
+        int64_t size = readInt();
+        for (int64_t i = 0; i < size and not failed; i++) {
+            auto place = static_cast<TABLE_PLACE>(readInt());
+            placeMap[place] = static_cast<V>(readInt());
+        }
+    }
+
+    /// @brief Returns true if state was malformed.
+    bool hasFailed() const;
+};
+
+#endif // KIERKI_STATESERIALIZER_H
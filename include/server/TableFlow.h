@@ -0,0 +1,144 @@
+#ifndef KIERKI_TABLEFLOW_H
+#define KIERKI_TABLEFLOW_H
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+/// What table flow is suspended on.
+enum class FLOW_WAIT {
+    NOTHING,
+    TABLE_READY, // Every place is taken and rejoining players caught up.
+    SENT,        // Everything queued for seat was written.
+    TRICK,       // Seat placed a card or timed out.
+};
+
+/// Why table flow was resumed.
+enum class SEAT_EVENT {
+    DONE,
+    TIMED_OUT,
+    LEFT,
+};
+
+/// @brief Coroutine playing game at a table. It starts suspended and from then on is resumed by
+/// event loop only when the single thing it waits for happens.
+class TableFlow {
+  public:
+    struct promise_type {
+        TableFlow get_return_object() {
+            return TableFlow(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() {}
+
+        void unhandled_exception() {
+            std::terminate();
+        }
+    };
+
+    TableFlow() = default;
+
+    explicit TableFlow(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    TableFlow(TableFlow &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+    TableFlow &operator=(TableFlow &&other) noexcept {
+        if (this != &other) {
+            destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+
+    TableFlow(const TableFlow &) = delete;
+    TableFlow &operator=(const TableFlow &) = delete;
+
+    ~TableFlow() {
+        destroy();
+    }
+
+    /// @brief Runs flow until it waits for something for the first time.
+    void start() {
+        if (handle and not handle.done()) {
+            handle.resume();
+        }
+    }
+
+  private:
+    std::coroutine_handle<promise_type> handle = nullptr;
+
+    void destroy() {
+        if (handle) {
+            handle.destroy();
+            handle = nullptr;
+        }
+    }
+};
+
+/// @brief The only place where table flow parks itself. Table is a sequence of awaits, so one
+/// slot is enough and resuming it is a single check, without any queue of runnable tasks.
+struct TableWait {
+    std::coroutine_handle<> handle = nullptr;
+    FLOW_WAIT waitsFor = FLOW_WAIT::NOTHING;
+    int seat = -1;
+    SEAT_EVENT event = SEAT_EVENT::DONE;
+
+    /// @brief Returns true if flow waits for given thing at given seat.
+    bool waitsAt(FLOW_WAIT what, int index) const {
+        return waitsFor == what and seat == index;
+    }
+
+    /// @brief Resumes flow with given event if it waits for given thing at given seat.
+    void resume(FLOW_WAIT what, int index, SEAT_EVENT seatEvent) {
+        if (not waitsAt(what, index)) {
+            return;
+        }
+
+        // Slot is cleared first, flow may park itself again before resume returns.
+        std::coroutine_handle<> parked = std::exchange(handle, nullptr);
+        waitsFor = FLOW_WAIT::NOTHING;
+        seat = -1;
+        event = seatEvent;
+        parked.resume();
+    }
+
+    /// @brief Resumes flow with LEFT if it waits for anything at given seat.
+    void seatLeft(int index) {
+        resume(FLOW_WAIT::SENT, index, SEAT_EVENT::LEFT);
+        resume(FLOW_WAIT::TRICK, index, SEAT_EVENT::LEFT);
+    }
+};
+
+/// @brief Awaitable parking flow in table wait. If it is ready, flow goes on at once and gets
+/// readyEvent.
+struct SeatAwaiter {
+    TableWait &tableWait;
+    FLOW_WAIT waitsFor;
+    int seat;
+    bool ready;
+    SEAT_EVENT readyEvent = SEAT_EVENT::DONE;
+
+    bool await_ready() const noexcept {
+        return ready;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) noexcept {
+        tableWait.handle = handle;
+        tableWait.waitsFor = waitsFor;
+        tableWait.seat = seat;
+    }
+
+    SEAT_EVENT await_resume() const noexcept {
+        return ready ? readyEvent : tableWait.event;
+    }
+};
+
+#endif // KIERKI_TABLEFLOW_H
@@ -6,9 +6,11 @@
 #include <sys/poll.h>
 #include <sys/types.h>
 
+#include <cassert>
 #include <iostream>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <errno.h>
@@ -33,31 +35,115 @@
 #include <sys/poll.h>
 
 #include "common/common.h"
+#include "common/frame.h"
+#include "common/rules.h"
 
 namespace ServerConstants {
 const int ACCEPT_INDEX = 4;
-const int CONNECTIONS = 512;
+const int UNIX_ACCEPT_INDEX = ACCEPT_INDEX + 1; // Unix domain socket for bots on the same host.
+const int METRICS_INDEX = UNIX_ACCEPT_INDEX + 1;
+const int METRICS_CONNECTIONS = 8;
+const int METRICS_END = METRICS_INDEX + 1 + METRICS_CONNECTIONS;
+const int UPGRADE_INDEX = METRICS_END;
+const int FIRST_CONNECTION = UPGRADE_INDEX + 1; // Clients who are not players, table grows here.
+const int SLAB_SIZE = 1024;
+const int MAX_CONNECTIONS = 256 * SLAB_SIZE;
 const int DEFAULT_TIMEOUT = 5;
 const int DEFAULT_PORT = 0;
-const int QUEUE_LENGTH = 5;
+const int QUEUE_LENGTH = 128;
 const int BUFFER_SIZE = 1024;
+const size_t DEFAULT_READ_LIMIT = 4 * 1024;   // Client messages are a few bytes long.
+const size_t DEFAULT_WRITE_LIMIT = 64 * 1024; // Catch-up after rejoin is below 1 KiB.
 const std::string GAME_FULL_MESSAGE = "BUSYNESW\r\n";
 } // namespace ServerConstants
 
 struct ServerArguments {
     char *portStr;
-    char *fileStr;
+    std::vector<char *> fileStrs; // Daemon plays games from these files in rotation.
     char *timeoutStr;
+    char *metricsPortStr;
+    char *queueLengthStr;
+    char *journalStr;
+    char *upgradeStr;
+    char *readLimitStr;
+    char *writeLimitStr;
+    char *socketOptionsStr;
+    char *unixPathStr;
+    char *botGraceStr;
+    char *reportStr;
 
     int timeout;
+    int botGrace; // Seconds before server plays seat of disconnected player, -1 if never.
+    int queueLength;
     uint16_t port;
+    uint16_t metricsPort;
+    size_t readLimit;
+    size_t writeLimit;
+    SocketOptions socketOptions;
+    bool lobbyEnabled;
+    bool spectatorsEnabled;
+    bool daemonEnabled;
 
     ServerArguments() {
         portStr = nullptr;
-        fileStr = nullptr;
         timeoutStr = nullptr;
+        metricsPortStr = nullptr;
+        queueLengthStr = nullptr;
+        journalStr = nullptr;
+        upgradeStr = nullptr;
+        readLimitStr = nullptr;
+        writeLimitStr = nullptr;
+        socketOptionsStr = nullptr;
+        unixPathStr = nullptr;
+        botGraceStr = nullptr;
+        reportStr = nullptr;
         timeout = ServerConstants::DEFAULT_TIMEOUT;
+        queueLength = ServerConstants::QUEUE_LENGTH;
+        botGrace = Constants::ERROR_CODE;
         port = ServerConstants::DEFAULT_PORT;
+        metricsPort = ServerConstants::DEFAULT_PORT;
+        readLimit = ServerConstants::DEFAULT_READ_LIMIT;
+        writeLimit = ServerConstants::DEFAULT_WRITE_LIMIT;
+        lobbyEnabled = false;
+        spectatorsEnabled = false;
+        daemonEnabled = false;
+    }
+};
+
+struct ServerLobby {
+    std::map<TABLE_PLACE, std::deque<int>> waitingAt;
+
+    /// @brief Parks client at given index in queue for place and returns his position.
+    int park(TABLE_PLACE place, int index) {
+        waitingAt[place].push_back(index);
+        return (int)waitingAt[place].size();
+    }
+
+    /// @brief Returns true if someone waits for given place.
+    bool hasWaiting(TABLE_PLACE place) {
+        return not waitingAt[place].empty();
+    }
+
+    /// @brief Removes and returns index of first client waiting for given place.
+    int popFirst(TABLE_PLACE place) {
+        int index = waitingAt[place].front();
+        waitingAt[place].pop_front();
+        return index;
+    }
+
+    /// @brief Removes client at given index and returns {place, position} he waited at or
+    /// {UNDEFINED, -1} if he was not waiting.
+    std::pair<TABLE_PLACE, int> remove(int index) {
+        for (auto &[place, queue] : waitingAt) {
+            for (int position = 0; position < (int)queue.size(); position++) {
+                if (queue[position] == index) {
+                    queue.erase(queue.begin() + position);
+                    return {place, position + 1};
+                }
+            }
+        }
+
+        return {TABLE_PLACE::UNDEFINED, -1};
     }
 };
 
@@ -70,20 +156,29 @@ struct ServerHand {
     std::vector<Card> currentlyPlacedCards;
 
     std::map<TABLE_PLACE, std::string> dealStrAtPlace;
-    std::vector<std::string> previousTaken;
+    std::map<TABLE_PLACE, std::string> dealBinaryAtPlace;
 
-    std::map<TABLE_PLACE, std::vector<Card>> playerCards;
-    std::map<TABLE_PLACE, uint64_t> playerScores;
+    // TAKEN messages of finished tricks concatenated, so rejoining player gets them in one write.
+    std::string previousTaken;
+    std::string previousTakenBinary;
 
-    void deleteCard(int index) {
-        // Swap with last element.
-        std::swap(playerCards[currentClient][index], playerCards[currentClient].back());
+    // Cards still held by players as masks of card ids, indexed by table place.
+    uint64_t playerCards[Constants::PLAYERS_NUMBER] = {};
+    std::map<TABLE_PLACE, uint64_t> playerScores;
 
-        // Delete last element.
-        playerCards[currentClient].pop_back();
+    /// @brief Appends taken message of just finished trick to catch-up buffers.
+    void appendTaken(std::string_view takenStr, std::string_view takenBinary) {
+        if (previousTaken.empty()) {
+            previousTaken.reserve(Constants::TRICK_NUMBER * takenStr.size());
+            previousTakenBinary.reserve(Constants::TRICK_NUMBER * takenBinary.size());
+        }
+        previousTaken += takenStr;
+        previousTakenBinary += takenBinary;
     }
 };
 
+Frame getTakenMessage(ServerHand &hand, Frame &binaryTakenMessage);
+
 struct ServerStatus {
     int activePlayers = 0;
     int currentHand = 0;
@@ -102,7 +197,7 @@ struct ServerStatus {
     }
 
     /// @brief Returns current hand.
-    ServerHand getCurrentHand() {
+    ServerHand &getCurrentHand() {
         return hands[currentHand];
     }
 
@@ -111,61 +206,32 @@ struct ServerStatus {
         return hands[currentHand].currentTrick;
     }
 
-    /// @brief Returns set of player's cards.
-    std::vector<Card> getPlayerCards(TABLE_PLACE player) {
-        return hands[currentHand].playerCards[player];
-    }
-
-    /// @brief Returns True if placed card's color is valid and False otherwise.
-    bool isValidColor(std::vector<Card> &playerCards, Card card) {
-        if (hands[currentHand].currentlyPlacedCards.empty()) {
-            return true;
-        }
-
-        bool hasMatchingCard = false;
-        CARD_COLOR firstPlacedColor = hands[currentHand].currentlyPlacedCards.front().cardColor;
+    /// @brief Returns mask of cards that player can place in current trick.
+    uint64_t getLegalMoves(TABLE_PLACE player) {
+        ServerHand &hand = hands[currentHand];
+        int ledCardId = hand.currentlyPlacedCards.empty()
+                            ? Constants::ERROR_CODE
+                            : getCardId(hand.currentlyPlacedCards.front());
 
-        for (auto playerCard : playerCards) {
-            if (playerCard.cardColor != firstPlacedColor) {
-                continue;
-            }
-
-            hasMatchingCard = true;
-            break;
-        }
-
-        if (hasMatchingCard and card.cardColor != firstPlacedColor) {
-            return false;
-        }
-
-        return true;
+        return ::getLegalMoves(hand.playerCards[static_cast<int>(player)], ledCardId);
     }
 
-    /// @brief Returns index in cards if player has card and -1 otherwise.
-    static int getCardIndex(std::vector<Card> &playerCards, Card card) {
-        for (int i = 0; i < (int)playerCards.size(); i++) {
-            if (card == playerCards[i]) {
-                return i;
-            }
-        }
-
-        return -1;
+    /// @brief Returns card server places for player who did not come back, the lowest legal one
+    /// like automatic client does. Player on turn always holds a card, so some card is legal.
+    Card getBotCard(TABLE_PLACE player) {
+        uint64_t legalMoves = getLegalMoves(player);
+        assert(legalMoves != 0); // __builtin_ctzll is undefined for 0.
+        return getCardFromId(__builtin_ctzll(legalMoves));
     }
 
     /// @brief Returns True if placed card is valid and False otherwise.
     bool playerPlacesCard(TABLE_PLACE player, Card card) {
-        std::vector<Card> playerCards = getPlayerCards(player);
-
-        int cardIndex;
-        if ((cardIndex = getCardIndex(playerCards, card)) == -1) {
+        uint64_t cardMask = 1ULL << getCardId(card);
+        if (not (getLegalMoves(player) & cardMask)) {
             return false;
         }
 
-        if (not isValidColor(playerCards, card)) {
-            return false;
-        }
-
-        hands[currentHand].deleteCard(cardIndex);
+        hands[currentHand].playerCards[static_cast<int>(player)] &= ~cardMask;
         hands[currentHand].currentlyPlacedCards.emplace_back(card);
 
         return true;
@@ -207,8 +273,8 @@ struct ServerStatus {
         dealSend[static_cast<TABLE_PLACE>(index)] = value;
     }
 
-    /// @brief Returns previous taken list.
-    std::vector<std::string> getPreviousTakenList() {
+    /// @brief Returns taken messages of finished tricks in current hand.
+    const std::string &getPreviousTaken() {
         return hands[currentHand].previousTaken;
     }
 
@@ -225,6 +291,20 @@ struct ServerStatus {
         return (activePlayers == Constants::PLAYERS_NUMBER) or (not gameStarted) or gameEnded;
     }
 
+    /// @brief Takes cards from table, passes turn to trick taker and returns taken message in
+    /// text and binary form.
+    std::pair<Frame, Frame> takeTrick() {
+        ServerHand &hand = hands[currentHand];
+        Frame binaryTakenMessage;
+        Frame takenMessage = getTakenMessage(hand, binaryTakenMessage);
+        hand.appendTaken(takenMessage.view(), binaryTakenMessage.view());
+
+        setCurrentTablePlace(getPreviousTrickTaker());
+        clearCardsFromTable();
+
+        return {takenMessage, binaryTakenMessage};
+    }
+
     /// @brief Increases current trick number.
     void finishTrick() {
         hands[currentHand].currentTrick++;
@@ -244,6 +324,10 @@ struct ServerStatus {
     }
 };
 
-std::string getTakenStr(ServerHand &hand);
+std::string getLocalIpv6AndPortAddress(int socketFd);
+
+std::string getLocalAddressStr(int socketFd, const sockaddr_in6 &clientAddress);
+
+std::string getClientAddressStr(int socketFd, const sockaddr_in6 &clientAddress);
 
 #endif // KIERKI_SERWER_COMMON_H
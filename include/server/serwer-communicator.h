@@ -12,20 +12,33 @@
 #include "common/common.h"
 #include "err/err.h"
 
+bool asksForBinary(const std::string &message);
+
 TABLE_PLACE parseIam(const std::string &message);
 
-std::string getBusyMessage(ServerContext &serverContext);
+bool parseSpectate(const std::string &message);
+
+bool parseShm(const std::string &message);
+
+Frame getBusyMessage(ServerContext &serverContext);
 
 void setDealTakenMessage(TABLE_PLACE tablePlace, ServerStatus &serverStatus,
                          ServerContext &serverContext);
-std::string getTrickMessage(ServerStatus &serverStatus);
+Frame getTrickMessage(ServerStatus &serverStatus);
+
+Frame getBinaryTrickMessage(ServerStatus &serverStatus);
 
 bool canTrickBeParsed(std::string message);
 
+bool canTrickBeParsed(const std::string &message, const CardsMessage &trick);
+
 bool parseTrickServer(std::string message, ServerStatus &server_status, TABLE_PLACE currentPlayer);
 
-std::string getWrongMessage(ServerStatus &serverStatus);
+bool parseTrickServer(const std::string &message, const CardsMessage &trick,
+                      ServerStatus &serverStatus, TABLE_PLACE currentPlayer);
+
+Frame getWrongMessage(ServerStatus &serverStatus);
 
-std::string getResultsMessage(ServerStatus &serverStatus, const std::string &which);
+Frame getResultsMessage(ServerStatus &serverStatus, const std::string &which);
 
 #endif // KIERKI_SERWER_COMMUNICATOR_H
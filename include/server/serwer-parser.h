@@ -11,6 +11,6 @@
 #include "err/err.h"
 
 void parseUserInput(int argc, char **argv, ServerArguments &serverArguments,
-                    ServerStatus &server_status);
+                    std::vector<ServerStatus> &games);
 
 #endif // KIERKI_SERWER_PARSER_H
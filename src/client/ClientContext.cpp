@@ -15,6 +15,17 @@ void ClientContext::createContext(const std::string &_clientAddressStr,
     initializePollStructures();
 }
 
+void ClientContext::attachShm(int memFd) {
+    if (not shmChannel.attach(memFd, socketFd, false)) {
+        sysFatal("mmap");
+    }
+}
+
+void ClientContext::closeConnection() {
+    shmChannel.release();
+    close(socketFd);
+}
+
 bool ClientContext::isGameFinished() {
     return clientHand.countResults == 2;
 }
@@ -73,17 +84,45 @@ void ClientContext::displayTricks() {
 }
 
 ssize_t ClientContext::sendMessageClient(std::string &message) {
+    if (shmChannel.isAttached()) {
+        return shmChannel.send(message.c_str(), message.size());
+    }
+
     return sendMessage(socketFd, message.c_str(), message.size());
 }
 
-void ClientContext::initiateSending(std::string message) {
+ssize_t ClientContext::receiveMessageClient(char *buffer, size_t len) {
+    if (shmChannel.isAttached()) {
+        return shmChannel.receive(buffer, len);
+    }
+
+    return read(socketFd, buffer, len);
+}
+
+void ClientContext::initiateSending(std::string_view message, std::string_view binaryMessage) {
+    std::string encoded;
+    if (serverBuffer.binary and binaryMessage.empty()) {
+        encoded = encodeBinary(message);
+        binaryMessage = encoded;
+    }
+
+    // Empty write would look like closed server, so message that cannot be encoded is skipped.
+    if (serverBuffer.binary and binaryMessage.empty()) {
+        error("cannot encode message in binary: %.*s", (int)message.size(), message.data());
+        return;
+    }
+
     pollDescriptors[ClientConstants::SERVER_INDEX].events |= POLLOUT;
+    writeBuffer.appendMessage(serverBuffer.binary ? binaryMessage : message);
+}
 
-    writeBuffer.appendMessage(message);
+void ClientContext::setBinary() {
+    serverBuffer.binary = true;
+    serverBuffer.scanned = 0;
 }
 
 void ClientContext::setPlayerCards(std::vector<Card> cards) {
-    clientHand.clientCards = cards;
+    clientHand.setCards(cards);
 }
 
 void ClientContext::setHandType(HAND_TYPE handType) {
@@ -141,6 +180,7 @@ void ClientContext::afterReceivingScore() {
     if (clientHand.countResults == 2) {
         clientHand.trickNumber = 1;
         clientHand.clientCards.clear();
+        clientHand.clientCardsMask = 0;
     }
 }
 
@@ -157,6 +197,7 @@ void ClientContext::afterReceivingTotal() {
     if (clientHand.countResults == 2) {
         clientHand.trickNumber = 1;
         clientHand.clientCards.clear();
+        clientHand.clientCardsMask = 0;
     }
 }
 
@@ -177,8 +218,39 @@ int ClientContext::getPollDescriptorAt(int index) {
 }
 
 int ClientContext::executePoll() {
-    return poll(pollDescriptors, ClientConstants::CLIENT_CONNECTIONS,
-                ClientConstants::CLIENT_TIMEOUT);
+    if (not shmChannel.isAttached()) {
+        return poll(pollDescriptors, ClientConstants::CLIENT_CONNECTIONS,
+                    ClientConstants::CLIENT_TIMEOUT);
+    }
+
+    pollfd &server = pollDescriptors[ClientConstants::SERVER_INDEX];
+    int timeout = ClientConstants::CLIENT_TIMEOUT;
+
+    // Bot answers from shared memory without sleeping, unless it has something to write.
+    if (shmChannel.isBlocked()) {
+        server.events &= ~POLLOUT;
+    }
+    if (not(server.events & POLLOUT) and
+        (shmChannel.waitForInput(ShmConstants::CLIENT_SPIN_MICROS) or not shmChannel.setIdle())) {
+        timeout = 0;
+    }
+
+    int pollStatus = poll(pollDescriptors, ClientConstants::CLIENT_CONNECTIONS, timeout);
+    if (pollStatus < 0) {
+        return pollStatus;
+    }
+
+    shmChannel.setBusy(server.revents & (POLLIN | POLLERR | POLLHUP));
+    short revents = server.revents;
+    if (shmChannel.hasInput()) {
+        server.revents |= POLLIN;
+    }
+    if (shmChannel.takeUnblocked() and writeBuffer.hasMessage()) {
+        server.events |= POLLOUT;
+        server.revents |= POLLOUT;
+    }
+
+    return revents == 0 and server.revents != 0 ? pollStatus + 1 : pollStatus;
 }
 
 void ClientContext::setReadAt(int index) {
@@ -205,8 +277,17 @@ bool ClientContext::hasServerMessage() {
     return serverBuffer.networkMessageLen() > 0;
 }
 
-std::string ClientContext::popFirstServerMessage() {
-    return serverBuffer.popFirstNetworkMessage();
+std::string ClientContext::popFirstServerMessage(CardsMessage &cardsMessage) {
+    cardsMessage.parsed = false;
+    if (not serverBuffer.binary) {
+        return serverBuffer.popFirstNetworkMessage();
+    }
+
+    std::string message = serverBuffer.popFirstNetworkMessage();
+    if (readCardsMessage(message, cardsMessage)) {
+        return std::string(getCardsMessageFrame(cardsMessage).view());
+    }
+    return std::string(decodeBinaryFrame(message).view());
 }
 
 bool ClientContext::hasWriteMessage() {
@@ -218,6 +299,9 @@ std::string ClientContext::getFirstWriteMessage() {
 }
 
 std::string ClientContext::getCurrentWriteMessage() {
+    if (serverBuffer.binary) {
+        return decodeBinary(writeBuffer.getCurrentMessage());
+    }
     return writeBuffer.getCurrentMessage();
 }
 
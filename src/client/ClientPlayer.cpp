@@ -1,7 +1,7 @@
 #include "client/ClientPlayer.h"
 
 void ClientPlayer::clientInitiate() {
-    clientContext.initiateSending(getIamMessage(clientArguments));
+    clientContext.initiateSending(getIamMessage(clientArguments).view());
 }
 
 void ClientPlayer::receiveBusy(std::string serverMessage) {
@@ -10,8 +10,12 @@ void ClientPlayer::receiveBusy(std::string serverMessage) {
     }
 }
 
-void ClientPlayer::receiveDeal(std::string serverMessage) {
-    if (not parseDeal(serverMessage, clientContext)) {
+void ClientPlayer::receiveQueue(std::string serverMessage) {
+    parseQueue(serverMessage, clientContext);
+}
+
+void ClientPlayer::receiveDeal(std::string serverMessage, const CardsMessage &cardsMessage) {
+    if (not parseDeal(serverMessage, cardsMessage, clientContext)) {
         return;
     }
 
@@ -19,8 +23,8 @@ void ClientPlayer::receiveDeal(std::string serverMessage) {
     clientContext.afterReceivingDeal();
 }
 
-void ClientPlayer::receiveTrick(std::string serverMessage) {
-    auto [isCorrect, placedCards] = parseTrickClient(serverMessage, clientContext);
+void ClientPlayer::receiveTrick(std::string serverMessage, const CardsMessage &cardsMessage) {
+    auto [isCorrect, placedCards] = parseTrickClient(serverMessage, cardsMessage, clientContext);
     if (not isCorrect) {
         // An error occurred.
         return;
@@ -33,13 +37,12 @@ void ClientPlayer::receiveTrick(std::string serverMessage) {
         return;
     }
 
-    std::string messageStr = strTrickClient(placedCards, clientContext.getClientHand());
-
-    clientContext.initiateSending(messageStr);
+    Card selectedCard = selectTrickCard(placedCards, clientContext.getClientHand());
+    sendTrick(selectedCard);
 }
 
-void ClientPlayer::receiveTaken(std::string serverMessage) {
-    std::vector<Card> trickCards = parseTaken(serverMessage, clientContext);
+void ClientPlayer::receiveTaken(std::string serverMessage, const CardsMessage &cardsMessage) {
+    std::vector<Card> trickCards = parseTaken(serverMessage, cardsMessage, clientContext);
     if (trickCards.empty()) {
         return;
     }
@@ -71,24 +74,38 @@ void ClientPlayer::receiveTotal(std::string serverMessage) {
     clientContext.afterReceivingTotal();
 }
 
-void ClientPlayer::handleMessageFromServer(std::string serverMessage) {
+void ClientPlayer::sendTrick(Card &card) {
+    ClientHand clientHand = clientContext.getClientHand();
+    Frame trickMessage = cardToTrick(card, clientHand);
+    Frame binaryTrickMessage = cardToBinaryTrick(card, clientHand);
+
+    clientContext.initiateSending(trickMessage.view(), binaryTrickMessage.view());
+}
+
+void ClientPlayer::handleMessageFromServer(std::string serverMessage,
+                                           const CardsMessage &cardsMessage) {
     if (clientContext.getClientHand().waitingForBusy() and canBeBusy(serverMessage)) {
         receiveBusy(serverMessage);
         return;
     }
 
+    if (clientContext.getClientHand().waitingForBusy() and canBeQueue(serverMessage)) {
+        receiveQueue(serverMessage);
+        return;
+    }
+
     if (clientContext.getClientHand().waitingForDeal() and canBeDeal(serverMessage)) {
-        receiveDeal(serverMessage);
+        receiveDeal(serverMessage, cardsMessage);
         return;
     }
 
     if (clientContext.getClientHand().waitingForTrick() and canBeTrick(serverMessage)) {
-        receiveTrick(serverMessage);
+        receiveTrick(serverMessage, cardsMessage);
         return;
     }
 
     if (clientContext.getClientHand().waitingForTaken() and canBeTaken(serverMessage)) {
-        receiveTaken(serverMessage);
+        receiveTaken(serverMessage, cardsMessage);
         return;
     }
 
@@ -124,8 +141,7 @@ void ClientPlayer::handleMessageFromUser(const std::string &userMessage) {
             return;
         }
 
-        std::string messageStr = cardToTrick(cardToSend, clientContext.getClientHand());
-        clientContext.initiateSending(messageStr);
+        sendTrick(cardToSend);
 
         break;
     }
@@ -173,70 +189,98 @@ void ClientPlayer::pollFromUser(char *buffer) {
 }
 
 int ClientPlayer::pollFromServer(char *buffer) {
-    ssize_t readLen = read(clientContext.getPollDescriptorAt(ClientConstants::SERVER_INDEX), buffer,
-                           ClientConstants::BUFFER_SIZE);
+    ssize_t readLen = clientContext.receiveMessageClient(buffer, ClientConstants::BUFFER_SIZE);
+
+    if (readLen < 0 and errno == EAGAIN) {
+        return ClientConstants::GAME_NOT_FINISHED; // Only a doorbell of shared memory.
+    }
 
     if (readLen == 0 and clientContext.isGameFinished()) {
         return ClientConstants::GAME_FINISHED;
     }
 
+    // Session reconnects to server, single game ends.
+    if (readLen <= 0 and clientArguments.session) {
+        return ClientConstants::GAME_DISCONNECTED;
+    }
+
     if (readLen == 0) {
         fatal("server disconnected");
     } else if (readLen < 0) {
         sysFatal("read");
     }
 
+    rearmQuickAck(clientContext.getPollDescriptorAt(ClientConstants::SERVER_INDEX),
+                  clientArguments.socketOptions);
+
     std::string readMsg(buffer, readLen);
     clientContext.appendServerRead(readMsg);
 
+    CardsMessage cardsMessage;
     while (clientContext.hasServerMessage()) {
-        std::string serverMessage = clientContext.popFirstServerMessage();
+        std::string serverMessage = clientContext.popFirstServerMessage(cardsMessage);
         clientContext.displayMessageFromServer(serverMessage);
 
         if (not clientContext.hasWriteMessage()) {
-            handleMessageFromServer(serverMessage);
+            handleMessageFromServer(serverMessage, cardsMessage);
         }
     }
 
     return ClientConstants::GAME_NOT_FINISHED;
 }
 
-void ClientPlayer::writeToServer() {
+int ClientPlayer::writeToServer() {
     std::string message = clientContext.getFirstWriteMessage();
     ssize_t sentLen = clientContext.sendMessageClient(message);
     if (sentLen <= 0) {
         if (sentLen < 0 and (errno == EAGAIN or errno == EWOULDBLOCK)) {
-            return;
+            return ClientConstants::GAME_NOT_FINISHED;
         }
 
+        if (clientArguments.session) {
+            return ClientConstants::GAME_DISCONNECTED;
+        }
         sysFatal("write");
     }
 
     std::string currentMessage = clientContext.getCurrentWriteMessage();
 
     if (not clientContext.wroteWholeWriteMessage(sentLen)) {
-        return;
+        return ClientConstants::GAME_NOT_FINISHED;
     }
 
     clientContext.displayMessageFromClient(currentMessage);
 
+    // Server answers IAM asking for binary protocol in binary.
+    if (clientArguments.binary and canBeIam(currentMessage)) {
+        clientContext.setBinary();
+    }
+
     if (canBeTrick(currentMessage)) {
         clientContext.setSentTrickTo(true);
     }
 
     clientContext.setReadAt(ClientConstants::SERVER_INDEX);
+    return ClientConstants::GAME_NOT_FINISHED;
 }
 
-ClientPlayer::ClientPlayer(int _socketFd, const ClientArguments &_clientArguments,
+ClientPlayer::ClientPlayer(int _socketFd, int _memFd, const ClientArguments &_clientArguments,
                            const std::string &_serverAddressStr,
                            const std::string &_clientAddressStr)
     : clientArguments(_clientArguments), serverAddressStr(_serverAddressStr),
       clientAddressStr(_clientAddressStr) {
     clientContext.createContext(_clientAddressStr, _serverAddressStr, _socketFd,
                                 _clientArguments.isAutomatic, _clientArguments.tablePlace);
+    if (_memFd >= 0) {
+        clientContext.attachShm(_memFd);
+    }
 }
 
-void ClientPlayer::handleGame() {
+void ClientPlayer::closeConnection() {
+    clientContext.closeConnection();
+}
+
+int ClientPlayer::handleGame() {
     // Client sends IAM.
     clientInitiate();
 
@@ -260,13 +304,17 @@ void ClientPlayer::handleGame() {
         }
 
         if (clientContext.pollReadFromServer()) {
-            if (pollFromServer(buffer) == ClientConstants::GAME_FINISHED) {
-                return;
+            int gameStatus = pollFromServer(buffer);
+            if (gameStatus != ClientConstants::GAME_NOT_FINISHED) {
+                return gameStatus;
             }
         }
 
         if (clientContext.pollWriteToServer()) {
-            writeToServer();
+            int gameStatus = writeToServer();
+            if (gameStatus != ClientConstants::GAME_NOT_FINISHED) {
+                return gameStatus;
+            }
         }
     }
 }
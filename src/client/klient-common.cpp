@@ -14,31 +14,19 @@ void displayCardsVector(std::vector<Card> &cards, bool endWithDot) {
 }
 
 /// @brief Returns trick message to send.
-std::string cardToTrick(Card &card, ClientHand clientHand) {
-    std::string cardStr = card.toStr();
-
-    std::string message = Messages::TRICK;
-    message += std::to_string(clientHand.trickNumber) + cardStr;
-    message += Messages::END_OF_MESSAGE;
-
-    return message;
+Frame cardToTrick(Card &card, ClientHand clientHand) {
+    return getTrickFrame(clientHand.trickNumber, {&card, 1});
 }
 
-/// @brief Automatic selecting card for trick.
-std::string strTrickClient(std::vector<Card> &currentCards, ClientHand clientHand) {
-    int cardsNum = (int)clientHand.clientCards.size() - 1;
-    Card selectedCard = clientHand.clientCards[cardsNum];
-
-    if (not currentCards.empty()) {
-        Card firstCard = currentCards[0];
+/// @brief Returns trick message to send in binary protocol.
+Frame cardToBinaryTrick(Card &card, ClientHand clientHand) {
+    return getBinaryTrickFrame(clientHand.trickNumber, {&card, 1});
+}
 
-        for (int i = 0; i < cardsNum; i++) {
-            if (firstCard.cardColor == clientHand.clientCards[i].cardColor) {
-                selectedCard = clientHand.clientCards[i];
-                break;
-            }
-        }
-    }
+/// @brief Automatic selecting card for trick, lowest legal card is placed.
+Card selectTrickCard(std::vector<Card> &currentCards, ClientHand clientHand) {
+    int ledCardId = currentCards.empty() ? Constants::ERROR_CODE : getCardId(currentCards[0]);
+    uint64_t legalMoves = getLegalMoves(clientHand.clientCardsMask, ledCardId);
 
-    return cardToTrick(selectedCard, clientHand);
-}
\ No newline at end of file
+    return getCardFromId(__builtin_ctzll(legalMoves));
+}
@@ -65,12 +65,8 @@ static void displayResultsInformation(std::string expected,
 }
 
 /// @brief Returns Iam message.
-std::string getIamMessage(ClientArguments client_arguments) {
-    std::string message = Messages::IAM;
-    message += tablePlaceToChar(static_cast<int>(client_arguments.tablePlace));
-    message += Messages::END_OF_MESSAGE;
-
-    return message;
+Frame getIamMessage(ClientArguments client_arguments) {
+    return getIamFrame(client_arguments.tablePlace, client_arguments.binary);
 }
 
 /// @brief Returns True if message is valid BUSY and false otherwise.
@@ -101,8 +97,53 @@ bool parseBusy(const std::string &message, ClientContext &clientContext) {
     return true;
 }
 
-/// @brief Returns True if message is valid deal and false otherwise.
-bool parseDeal(std::string message, ClientContext &clientContext) {
+/// @brief Returns True if message is valid QUEUE and false otherwise.
+bool parseQueue(const std::string &message, ClientContext &clientContext) {
+    // message ? QUEUE....\r\n
+    if (message.size() < 8 or not canBeQueue(message)) {
+        return false;
+    }
+
+    for (int i = 5; i < (int)message.size() - 2; i++) {
+        if (message[i] < '0' or message[i] > '9') {
+            return false;
+        }
+    }
+
+    if (not clientContext.isClientAutomatic()) {
+        std::cout << "Place busy, waiting in lobby at position "
+                  << message.substr(5, message.size() - 7) << "." << std::endl;
+    }
+
+    return true;
+}
+
+/// @brief Sets hand from deal, returns false if cards are not a whole hand.
+static bool applyDeal(HAND_TYPE handType, TABLE_PLACE previousTrickTaker,
+                      const std::vector<Card> &playerCards, ClientContext &clientContext) {
+    if (playerCards.size() != Constants::CARDS_NUMBER) {
+        return false;
+    }
+
+    clientContext.setHandType(handType);
+    clientContext.setPreviousTrickTaker(previousTrickTaker);
+    clientContext.setPlayerCards(playerCards);
+
+    if (not clientContext.isClientAutomatic()) {
+        displayDealInformation(clientContext.getClientHand());
+    }
+
+    return true;
+}
+
+/// @brief Returns True if message is valid deal and false otherwise. Deal read from binary
+/// message is used instead of text if there is one.
+bool parseDeal(std::string message, const CardsMessage &deal, ClientContext &clientContext) {
+    if (deal.parsed) {
+        return deal.type == BINARY_TYPE::DEAL and
+               applyDeal(deal.handType, deal.place, deal.cards, clientContext);
+    }
+
     if (message.size() < 9 or not canBeDeal(message)) {
         return false;
     }
@@ -113,25 +154,36 @@ bool parseDeal(std::string message, ClientContext &clientContext) {
         return false;
     }
 
-    clientContext.setHandType(handType);
-    clientContext.setPreviousTrickTaker(previousTrickTaker);
-
     auto [isCorrect, playerCards] = parseCardsVector(message, 6, message.size() - 2);
-    if (not isCorrect or playerCards.size() != Constants::CARDS_NUMBER) {
+    if (not isCorrect) {
         return false;
     }
-    clientContext.setPlayerCards(playerCards);
 
+    return applyDeal(handType, previousTrickTaker, playerCards, clientContext);
+}
+
+/// @brief Displays trick to user, returns {True, list of placed cards}.
+static std::pair<bool, std::vector<Card>> acceptTrick(int trickNum,
+                                                      const std::vector<Card> &placedCards,
+                                                      ClientContext &clientContext) {
     if (not clientContext.isClientAutomatic()) {
-        displayDealInformation(clientContext.getClientHand());
+        displayTrickInformation(trickNum, placedCards, clientContext.getClientHand());
     }
 
-    return true;
+    return {true, placedCards};
 }
 
 /// @brief Returns {True, list of placed cards} if message is valid TRICK or {False, {}} otherwise.
-std::pair<bool, std::vector<Card>> parseTrickClient(std::string message,
+/// Trick read from binary message is used instead of text if there is one.
+std::pair<bool, std::vector<Card>> parseTrickClient(std::string message, const CardsMessage &trick,
                                                     ClientContext &clientContext) {
+    if (trick.parsed) {
+        if (trick.type != BINARY_TYPE::TRICK) {
+            return {false, {}};
+        }
+        return acceptTrick(trick.trickNumber, trick.cards, clientContext);
+    }
+
     // message ? TRICK....\r\n
     if (message.size() < 7 or not canBeTrick(message)) {
         return {false, {}};
@@ -147,11 +199,7 @@ std::pair<bool, std::vector<Card>> parseTrickClient(std::string message,
         return {false, {}};
     }
 
-    if (not clientContext.isClientAutomatic()) {
-        displayTrickInformation(trickNum, placedCards, clientContext.getClientHand());
-    }
-
-    return {true, placedCards};
+    return acceptTrick(trickNum, placedCards, clientContext);
 }
 
 /// @brief Returns client index in current trick.
@@ -160,25 +208,11 @@ static int getClientIndex(int clientPlace, int previousTrickTaker) {
            Constants::PLAYERS_NUMBER;
 }
 
-/// @brief Returns a vector of placed cards if message is valid taken and empty vector otherwise.
-std::vector<Card> parseTaken(std::string message, ClientContext &clientContext) {
-    // message ? TAKEN....\r\n
-    if (message.size() < 7 or not canBeTaken(message)) {
-        return {};
-    }
-
-    auto [trickNum, cardsStart] = getTrickNumber(message, 5);
-    if (trickNum == Constants::ERROR_CODE) {
-        return {};
-    }
-
-    auto [isCorrect, placedCards] = parseCardsVector(message, cardsStart, message.size() - 3);
-    if (not isCorrect or placedCards.size() != Constants::PLAYERS_NUMBER) {
-        return {};
-    }
-
-    TABLE_PLACE takesTrick = charToTablePlace(message[message.size() - 3]);
-    if (takesTrick == TABLE_PLACE::UNDEFINED) {
+/// @brief Removes card of client placed in taken trick from hand, returns placed cards or empty
+/// vector if client did not place any of them.
+static std::vector<Card> applyTaken(int trickNum, const std::vector<Card> &placedCards,
+                                    TABLE_PLACE takesTrick, ClientContext &clientContext) {
+    if (placedCards.size() != Constants::PLAYERS_NUMBER) {
         return {};
     }
 
@@ -207,6 +241,40 @@ std::vector<Card> parseTaken(std::string message, ClientContext &clientContext)
     return placedCards;
 }
 
+/// @brief Returns a vector of placed cards if message is valid taken and empty vector otherwise.
+/// Taken read from binary message is used instead of text if there is one.
+std::vector<Card> parseTaken(std::string message, const CardsMessage &taken,
+                             ClientContext &clientContext) {
+    if (taken.parsed) {
+        if (taken.type != BINARY_TYPE::TAKEN) {
+            return {};
+        }
+        return applyTaken(taken.trickNumber, taken.cards, taken.place, clientContext);
+    }
+
+    // message ? TAKEN....\r\n
+    if (message.size() < 7 or not canBeTaken(message)) {
+        return {};
+    }
+
+    auto [trickNum, cardsStart] = getTrickNumber(message, 5);
+    if (trickNum == Constants::ERROR_CODE) {
+        return {};
+    }
+
+    auto [isCorrect, placedCards] = parseCardsVector(message, cardsStart, message.size() - 3);
+    if (not isCorrect) {
+        return {};
+    }
+
+    TABLE_PLACE takesTrick = charToTablePlace(message[message.size() - 3]);
+    if (takesTrick == TABLE_PLACE::UNDEFINED) {
+        return {};
+    }
+
+    return applyTaken(trickNum, placedCards, takesTrick, clientContext);
+}
+
 /// @brief Returns True if message is a valid wrong and false otherwise.
 bool parseWrong(std::string message, ClientContext &clientContext) {
     // message ? WRONG....\r\n
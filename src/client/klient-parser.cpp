@@ -5,6 +5,17 @@ static bool isClientPlace(char c) {
     return c == 'N' or c == 'E' or c == 'S' or c == 'W';
 }
 
+/// @brief Returns number of games in session, 0 means no limit.
+static int readGames(char const *string) {
+    char *endptr;
+    errno = 0;
+    unsigned long games = strtoul(string, &endptr, 10);
+    if (errno != 0 or *endptr != 0 or string[0] == '-' or games > INT32_MAX) {
+        fatal("%s is not a valid number of games", string);
+    }
+    return (int)games;
+}
+
 /// @brief Checks if client parameters are in proper form.
 static void validateClientParameters(int argc, char **argv) {
     for (int i = 1; i < argc;) {
@@ -14,12 +25,13 @@ static void validateClientParameters(int argc, char **argv) {
             fatal("unknown option");
         }
 
-        if (param[1] == '4' or param[1] == '6' or param[1] == 'a' or isClientPlace(param[1])) {
+        if (param[1] == '4' or param[1] == '6' or param[1] == 'a' or param[1] == 'm' or
+            param[1] == 'b' or isClientPlace(param[1])) {
             i += 1;
             continue;
         }
 
-        if (param[1] != 'h' and param[1] != 'p') {
+        if (param[1] != 'h' and param[1] != 'p' and param[1] != 'o' and param[1] != 'g') {
             fatal("unknown option");
         }
 
@@ -39,7 +51,7 @@ void parseUserInput(int argc, char **argv, ClientArguments &clientArguments) {
     opterr = 0;
     int c;
 
-    while ((c = getopt(argc, argv, "h:p:46NESWa")) != Constants::ERROR_CODE)
+    while ((c = getopt(argc, argv, "h:p:o:g:46NESWamb")) != Constants::ERROR_CODE)
         switch (c) {
         case 'h':
             clientArguments.host = optarg;
@@ -47,6 +59,12 @@ void parseUserInput(int argc, char **argv, ClientArguments &clientArguments) {
         case 'p':
             clientArguments.port = optarg;
             break;
+        case 'o':
+            clientArguments.socketOptionsStr = optarg;
+            break;
+        case 'g':
+            clientArguments.gamesStr = optarg;
+            break;
         case '4':
             clientArguments.aiFamily = AF_INET;
             break;
@@ -62,8 +80,14 @@ void parseUserInput(int argc, char **argv, ClientArguments &clientArguments) {
         case 'a':
             clientArguments.isAutomatic = true;
             break;
+        case 'm':
+            clientArguments.useShm = true;
+            break;
+        case 'b':
+            clientArguments.binary = true;
+            break;
         case '?':
-            if (optopt == 'h' or optopt == 'p')
+            if (optopt == 'h' or optopt == 'p' or optopt == 'o' or optopt == 'g')
                 fatal("Option -%c requires an argument.\n", optopt);
             else if (isprint(optopt))
                 fatal("Unknown option `-%c'.\n", optopt);
@@ -76,10 +100,31 @@ void parseUserInput(int argc, char **argv, ClientArguments &clientArguments) {
     if (clientArguments.host == nullptr)
         fatal("host required");
 
-    if (clientArguments.port == nullptr)
+    // Unix socket is named by host alone.
+    if (clientArguments.port == nullptr and not isUnixHost(clientArguments.host))
         fatal("port required");
 
     if (clientArguments.tablePlace == TABLE_PLACE::UNDEFINED) {
         fatal("place required");
     }
+
+    if (clientArguments.socketOptionsStr != nullptr) {
+        clientArguments.socketOptions = readSocketOptions(clientArguments.socketOptionsStr);
+    }
+
+    // Session keeps playing and reconnecting instead of exiting after the game.
+    if (clientArguments.gamesStr != nullptr) {
+        clientArguments.games = readGames(clientArguments.gamesStr);
+        clientArguments.session = true;
+    }
+
+    // Shared memory is handed over unix socket, so server has to be on this host.
+    if (clientArguments.useShm and not isUnixHost(clientArguments.host)) {
+        fatal("shared memory requires unix socket host");
+    }
+
+    // Options tune TCP, unix socket has nothing to tune.
+    if (isUnixHost(clientArguments.host)) {
+        clientArguments.socketOptions = {false, false, false};
+    }
 }
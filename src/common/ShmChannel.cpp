@@ -0,0 +1,257 @@
+#include "common/ShmChannel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <sys/mman.h>
+
+/// @brief Tells CPU that we spin, so sibling hyperthread gets more of the core.
+static inline void cpuRelax() {
+#if defined(__x86_64__) or defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+ssize_t ShmRing::push(const char *bytes, size_t len) {
+    // Head is written by the other process, so it is loaded once and checked before it is used.
+    uint64_t currentTail = tail.load(std::memory_order_relaxed);
+    uint64_t used = currentTail - head.load(std::memory_order_acquire);
+    if (used > ShmConstants::RING_SIZE) {
+        return Constants::ERROR_CODE;
+    }
+    len = std::min<uint64_t>(len, ShmConstants::RING_SIZE - used);
+
+    size_t offset = currentTail % ShmConstants::RING_SIZE;
+    size_t first = std::min(len, ShmConstants::RING_SIZE - offset);
+    memcpy(data + offset, bytes, first);
+    memcpy(data, bytes + first, len - first);
+
+    tail.store(currentTail + len, std::memory_order_release);
+    return (ssize_t)len;
+}
+
+ssize_t ShmRing::pop(char *bytes, size_t len) {
+    // Tail is written by the other process, so it is loaded once and checked before it is used.
+    uint64_t currentHead = head.load(std::memory_order_relaxed);
+    uint64_t available = tail.load(std::memory_order_acquire) - currentHead;
+    if (available > ShmConstants::RING_SIZE) {
+        return Constants::ERROR_CODE;
+    }
+    len = std::min<uint64_t>(len, available);
+
+    size_t offset = currentHead % ShmConstants::RING_SIZE;
+    size_t first = std::min(len, ShmConstants::RING_SIZE - offset);
+    memcpy(bytes, data + offset, first);
+    memcpy(bytes + first, data, len - first);
+
+    head.store(currentHead + len, std::memory_order_release);
+    return (ssize_t)len;
+}
+
+void ShmChannel::ringDoorbell() {
+    // Socket buffer holds plenty of doorbells and one is enough, so failed write changes nothing.
+    ssize_t sentLen = ::send(socketFd, &ShmConstants::DOORBELL, 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+    (void)sentLen;
+}
+
+bool ShmChannel::create(int _socketFd) {
+    int fd = memfd_create("kierki-shm", MFD_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    if (ftruncate(fd, sizeof(ShmRegion)) < 0 or not attach(fd, _socketFd, true)) {
+        close(fd);
+        return false;
+    }
+
+    new (region) ShmRegion();
+    return true;
+}
+
+bool ShmChannel::attach(int _memFd, int _socketFd, bool _isServer) {
+    void *mapped =
+        mmap(nullptr, sizeof(ShmRegion), PROT_READ | PROT_WRITE, MAP_SHARED, _memFd, 0);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+
+    region = static_cast<ShmRegion *>(mapped);
+    memFd = _memFd;
+    socketFd = _socketFd;
+    isServer = _isServer;
+    socketReady = false;
+    outboundBlocked = false;
+    return true;
+}
+
+void ShmChannel::release() {
+    if (region != nullptr) {
+        munmap(region, sizeof(ShmRegion));
+        close(memFd);
+    }
+
+    region = nullptr;
+    memFd = -1;
+    socketFd = -1;
+}
+
+ssize_t ShmChannel::send(const char *data, size_t len) {
+    ShmRing &ring = outbound();
+    ssize_t pushed = ring.push(data, len);
+
+    if (pushed == 0) {
+        // Reader could have made room between push and flag, so we look again after setting it.
+        ring.writerWaiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        pushed = ring.push(data, len);
+        if (pushed == 0) {
+            outboundBlocked = true;
+            errno = EAGAIN;
+            return -1;
+        }
+    }
+    if (pushed < 0) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    // Pairs with fence in setIdle: either reader sees new tail or we see that it sleeps.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (ring.readerIdle.load(std::memory_order_relaxed) != 0 and
+        ring.readerIdle.exchange(0, std::memory_order_relaxed) != 0) {
+        ringDoorbell();
+    }
+    return pushed;
+}
+
+ssize_t ShmChannel::receive(char *buffer, size_t len) {
+    bool otherSideGone = false;
+    if (socketReady) {
+        socketReady = false;
+        char doorbells[ShmConstants::DOORBELL_BUFFER];
+        ssize_t readLen;
+        while ((readLen = read(socketFd, doorbells, sizeof(doorbells))) > 0) {
+        }
+        otherSideGone = readLen == 0;
+    }
+
+    ShmRing &ring = inbound();
+    ssize_t popped = ring.pop(buffer, len);
+    if (popped < 0) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (popped > 0 and ring.writerWaiting.load(std::memory_order_relaxed) != 0 and
+        ring.writerWaiting.exchange(0, std::memory_order_relaxed) != 0) {
+        ringDoorbell();
+    }
+
+    if (popped > 0) {
+        return popped;
+    }
+    if (otherSideGone) {
+        return 0;
+    }
+
+    errno = EAGAIN;
+    return -1;
+}
+
+bool canSpin() {
+    static const bool spins = sysconf(_SC_NPROCESSORS_ONLN) > 1;
+    return spins;
+}
+
+bool ShmChannel::waitForInput(int spinMicros) const {
+    if (not canSpin()) {
+        return hasInput();
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(spinMicros);
+    do {
+        for (int i = 0; i < 64; i++) {
+            if (hasInput()) {
+                return true;
+            }
+            cpuRelax();
+        }
+    } while (std::chrono::steady_clock::now() < deadline);
+
+    return false;
+}
+
+bool ShmChannel::setIdle() {
+    ShmRing &ring = inbound();
+    ring.readerIdle.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return not ring.hasData();
+}
+
+void ShmChannel::setBusy(bool _socketReady) {
+    inbound().readerIdle.store(0, std::memory_order_relaxed);
+    socketReady = socketReady or _socketReady;
+}
+
+bool ShmChannel::takeUnblocked() {
+    if (not outboundBlocked or outbound().writerWaiting.load(std::memory_order_acquire) != 0) {
+        return false;
+    }
+
+    outboundBlocked = false;
+    return true;
+}
+
+bool sendMemFd(int socketFd, const std::string &message, int memFd) {
+    iovec iov = {const_cast<char *>(message.data()), message.size()};
+    char control[CMSG_SPACE(sizeof(int))];
+    memset(control, 0, sizeof(control));
+
+    msghdr header;
+    memset(&header, 0, sizeof(header));
+    header.msg_iov = &iov;
+    header.msg_iovlen = 1;
+    header.msg_control = control;
+    header.msg_controllen = sizeof(control);
+
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&header);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &memFd, sizeof(int));
+
+    // Fresh socket has empty send buffer, so short message is either written at once or not at all.
+    return sendmsg(socketFd, &header, MSG_DONTWAIT | MSG_NOSIGNAL) == (ssize_t)message.size();
+}
+
+int receiveMemFd(int socketFd, std::string &message) {
+    char buffer[ShmConstants::NEGOTIATION_BUFFER];
+    iovec iov = {buffer, sizeof(buffer)};
+    char control[CMSG_SPACE(sizeof(int))];
+
+    msghdr header;
+    memset(&header, 0, sizeof(header));
+    header.msg_iov = &iov;
+    header.msg_iovlen = 1;
+    header.msg_control = control;
+    header.msg_controllen = sizeof(control);
+
+    ssize_t readLen = recvmsg(socketFd, &header, MSG_CMSG_CLOEXEC);
+    if (readLen <= 0) {
+        return Constants::ERROR_CODE;
+    }
+    message.assign(buffer, readLen);
+
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&header);
+    if (cmsg == nullptr or cmsg->cmsg_level != SOL_SOCKET or cmsg->cmsg_type != SCM_RIGHTS) {
+        return Constants::ERROR_CODE;
+    }
+
+    int memFd;
+    memcpy(&memFd, CMSG_DATA(cmsg), sizeof(int));
+    return memFd;
+}
@@ -40,130 +40,61 @@ bool canBeTotal(const std::string &message) {
     return prefixEqual(message, Messages::TOTAL);
 }
 
-/// @brief Returns proper card color or undefined.
-static CARD_COLOR charToCardColor(char c) {
-    switch (c) {
-    case 'C':
-        return CARD_COLOR::C;
-    case 'D':
-        return CARD_COLOR::D;
-    case 'H':
-        return CARD_COLOR::H;
-    case 'S':
-        return CARD_COLOR::S;
-    default:
-        return CARD_COLOR::UNDEFINED;
-    }
-}
-
-/// @brief returns special card value or undefined.
-static CARD_VALUE charToCardValue(char c) {
-    switch (c) {
-    case 'J':
-        return CARD_VALUE::J;
-    case 'Q':
-        return CARD_VALUE::Q;
-    case 'K':
-        return CARD_VALUE::K;
-    case 'A':
-        return CARD_VALUE::A;
-    default:
-        return CARD_VALUE::UNDEFINED;
-    }
+/// @brief Returns true if message prefix is QUEUE.
+bool canBeQueue(const std::string &message) {
+    return prefixEqual(message, Messages::QUEUE);
 }
 
 /// @brief Returns true if character is card end.
 static bool isCardEnd(char c) {
-    return c == 'C' or c == 'D' or c == 'H' or c == 'S';
+    return CardConstants::COLOR_FROM_CHAR[static_cast<unsigned char>(c)] >= 0;
 }
 
 /// @brief converts table place int to char.
 char tablePlaceToChar(const int c) {
-    switch (c) {
-    case 0:
-        return 'N';
-    case 1:
-        return 'E';
-    case 2:
-        return 'S';
-    case 3:
-        return 'W';
-    default:
+    if (c < 0 or c >= Constants::PLAYERS_NUMBER) {
         return ' ';
     }
+    return CardConstants::PLACE_CHARS[c];
 }
 
 /// @brief converts char to table place.
 TABLE_PLACE charToTablePlace(const char &c) {
-    switch (c) {
-    case 'N':
-        return TABLE_PLACE::N;
-    case 'E':
-        return TABLE_PLACE::E;
-    case 'S':
-        return TABLE_PLACE::S;
-    case 'W':
-        return TABLE_PLACE::W;
-    default:
-        return TABLE_PLACE::UNDEFINED;
-    }
+    return static_cast<TABLE_PLACE>(CardConstants::PLACE_FROM_CHAR[static_cast<unsigned char>(c)]);
 }
 
 /// @brief converts char to hand type.
 HAND_TYPE charToHandType(const char &c) {
-    if ('1' <= c and c <= '7')
-        return static_cast<HAND_TYPE>(c - '0');
-    return HAND_TYPE::UNDEFINED;
+    return static_cast<HAND_TYPE>(
+        CardConstants::HAND_TYPE_FROM_CHAR[static_cast<unsigned char>(c)]);
 }
 
-/// @brief Returns true and sets card from string and returns false otherwise.
-bool setCardFromStr(Card &card, const std::string &str) {
+/// @brief Returns true and sets card from string and returns false otherwise. Card is recognized
+/// by its last two characters, the first of three can only be the 1 of 10.
+bool setCardFromStr(Card &card, std::string_view str) {
     size_t sz = str.size();
-
-    // First we need to set the color of the card.
-    card.cardColor = charToCardColor(str[sz - 1]);
-    if (card.cardColor == CARD_COLOR::UNDEFINED) {
+    if (sz < 2 or sz > 3) {
         return false;
     }
 
-    if (sz == 3 and str[0] == '1' and str[1] == '0') { // { card value == 10 }
-        card.cardValue = 10;
-        return true;
-    }
-
-    if (sz != 2) {
-        return false;
-    } // { sz == 2 }
-
-    if (str[0] >= '2' and str[0] <= '9') {
-        card.cardValue = str[0] - '0';
-        return true;
-    }
-
-    CARD_VALUE cardValue = charToCardValue(str[0]);
-    if (cardValue == CARD_VALUE::UNDEFINED) {
+    int color = CardConstants::COLOR_FROM_CHAR[static_cast<unsigned char>(str[sz - 1])];
+    int value = CardConstants::VALUE_FROM_CHAR[static_cast<unsigned char>(str[sz - 2])];
+    bool isTen = value == 10;
+    if (color < 0 or value < 0 or isTen != (sz == 3) or (isTen and str[0] != '1')) {
         return false;
     }
 
-    card.cardValue = static_cast<int>(cardValue);
-
+    card.cardColor = static_cast<CARD_COLOR>(color);
+    card.cardValue = value;
     return true;
 }
 
-/// @brief Returns cards string from vector.
-std::string getCardsStr(std::vector<Card> &cards) {
-    std::string str = "";
-    for (auto &card : cards) {
-        str += card.toStr();
-    }
-    return str;
-}
-
 /// @brief Function returns {true, cards vector} if valid message and {false, {}} otherwise.
 /// List of cards stats at message[start] and ends at message[end - 1].
 std::pair<bool, std::vector<Card>> parseCardsVector(const std::string &message, const size_t start,
                                                     const size_t end) {
     std::vector<Card> cards;
+    cards.reserve(Constants::CARDS_NUMBER);
     size_t cardStart = start;
 
     for (size_t i = start; i < end; i++) {
@@ -171,7 +102,7 @@ std::pair<bool, std::vector<Card>> parseCardsVector(const std::string &message,
             continue;
         }
 
-        std::string cardStr = message.substr(cardStart, (i - cardStart + 1));
+        std::string_view cardStr(message.data() + cardStart, i - cardStart + 1);
         Card currentCard = Card();
         if (not setCardFromStr(currentCard, cardStr)) {
             return {false, {}};
@@ -187,7 +118,7 @@ std::pair<bool, std::vector<Card>> parseCardsVector(const std::string &message,
         return {false, {}};
     }
 
-    return {true, cards};
+    return {true, std::move(cards)};
 }
 
 /// @brief Returns current date time to display.
@@ -215,6 +146,12 @@ ssize_t sendMessage(int socketFd, const void *vptr, size_t n) {
     return write(socketFd, vptr, n);
 }
 
+/// @brief Function is a wrapper for send telling kernel that more data follows at once, so it
+/// holds partial segment back until a write without this flag.
+ssize_t sendMessageMore(int socketFd, const void *vptr, size_t n) {
+    return send(socketFd, vptr, n, MSG_MORE);
+}
+
 /// @brief Returns true if prefix of message is equal to expected and false otherwise.
 bool prefixEqual(const std::string &message, std::string expected) {
     return message.size() >= expected.size() and message.substr(0, expected.size()) == expected;
@@ -270,6 +207,80 @@ uint16_t readPort(char const *string) {
     return (uint16_t)port;
 }
 
+/// @brief Reads comma separated list of socket options or "none".
+SocketOptions readSocketOptions(char const *string) {
+    SocketOptions socketOptions = {false, false, false};
+    if (string == SocketConstants::NONE) {
+        return socketOptions;
+    }
+
+    std::stringstream options(string);
+    std::string option;
+    while (std::getline(options, option, SocketConstants::SEPARATOR)) {
+        if (option == SocketConstants::NO_DELAY) {
+            socketOptions.noDelay = true;
+        } else if (option == SocketConstants::QUICK_ACK) {
+            socketOptions.quickAck = true;
+        } else if (option == SocketConstants::CORK) {
+            socketOptions.cork = true;
+        } else {
+            fatal("%s is not a valid list of socket options", string);
+        }
+    }
+
+    if (string[0] == 0 or string[strlen(string) - 1] == SocketConstants::SEPARATOR) {
+        fatal("%s is not a valid list of socket options", string);
+    }
+    return socketOptions;
+}
+
+/// @brief Applies options to connected socket. They only tune latency, so socket that does not
+/// support them works as it is.
+void applySocketOptions(int socketFd, const SocketOptions &socketOptions) {
+    int noDelay = socketOptions.noDelay;
+    setsockopt(socketFd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    rearmQuickAck(socketFd, socketOptions);
+}
+
+/// @brief Kernel leaves quick ACK mode on its own, so it is turned on again after every read.
+void rearmQuickAck(int socketFd, const SocketOptions &socketOptions) {
+    if (socketOptions.quickAck) {
+        int quickAck = 1;
+        setsockopt(socketFd, IPPROTO_TCP, TCP_QUICKACK, &quickAck, sizeof(quickAck));
+    }
+}
+
+/// @brief Returns true if host names unix domain socket.
+bool isUnixHost(const char *host) {
+    return std::string_view(host).starts_with(SocketConstants::UNIX_PREFIX);
+}
+
+/// @brief Sets unix socket address of given path and its length. Path starting with @ names socket
+/// in abstract namespace, which has no file and disappears with the last descriptor.
+bool setUnixAddress(sockaddr_un &address, socklen_t &addressLen, const char *path) {
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    size_t pathLen = strlen(path);
+    if (pathLen == 0 or pathLen >= sizeof(address.sun_path)) {
+        return false;
+    }
+
+    memcpy(address.sun_path, path, pathLen);
+    if (path[0] == SocketConstants::ABSTRACT_PREFIX) {
+        address.sun_path[0] = 0;
+        addressLen = (socklen_t)(offsetof(sockaddr_un, sun_path) + pathLen);
+    } else {
+        addressLen = (socklen_t)sizeof(address);
+    }
+    return true;
+}
+
+/// @brief Returns address of process at the other end of unix socket to log, unix peers have no
+/// names of their own.
+std::string getUnixPeerAddress(pid_t pid) {
+    return SocketConstants::UNIX_PREFIX + "pid=" + std::to_string(pid);
+}
+
 /// @brief Function returns ipv4 string to log.
 std::string getIpv4AndPortAddress(struct sockaddr_in addressIpv4) {
     char addressIp[INET_ADDRSTRLEN];
@@ -314,3 +325,9 @@ void setServerAddressIpv6(uint16_t port, struct addrinfo *address_result,
 
     freeaddrinfo(address_result);
 }
+
+/// @brief Returns microseconds elapsed since start.
+uint64_t microsSince(std::chrono::steady_clock::time_point start) {
+    auto duration = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
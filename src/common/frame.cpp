@@ -0,0 +1,478 @@
+#include "common/frame.h"
+
+Frame getIamFrame(TABLE_PLACE place, bool binary) {
+    Frame frame;
+    frame.append(Messages::IAM);
+    frame.append(tablePlaceToChar(static_cast<int>(place)));
+    if (binary) {
+        frame.append(BinaryConstants::IAM_FLAG);
+    }
+    frame.appendEnd();
+    return frame;
+}
+
+/// @brief Bit i of mask is set if table place i is taken.
+Frame getBusyFrame(uint32_t takenPlacesMask) {
+    Frame frame;
+    frame.append(Messages::BUSY);
+    for (int i = 0; i < Constants::PLAYERS_NUMBER; i++) {
+        if ((takenPlacesMask >> i) & 1) {
+            frame.append(tablePlaceToChar(i));
+        }
+    }
+    frame.appendEnd();
+    return frame;
+}
+
+Frame getQueueFrame(int position) {
+    Frame frame;
+    frame.append(Messages::QUEUE);
+    frame.appendNumber(position);
+    frame.appendEnd();
+    return frame;
+}
+
+Frame getDealFrame(HAND_TYPE handType, TABLE_PLACE firstPlayer, std::span<const Card> cards) {
+    Frame frame;
+    frame.append(Messages::DEAL);
+    frame.append(CardConstants::HAND_TYPE_CHARS[static_cast<int>(handType) + 1]);
+    frame.append(CardConstants::PLACE_CHARS[static_cast<int>(firstPlayer)]);
+    frame.appendCards(cards);
+    frame.appendEnd();
+    return frame;
+}
+
+Frame getTrickFrame(int trickNumber, std::span<const Card> cards) {
+    Frame frame;
+    frame.append(Messages::TRICK);
+    frame.appendNumber(trickNumber);
+    frame.appendCards(cards);
+    frame.appendEnd();
+    return frame;
+}
+
+Frame getWrongFrame(int trickNumber) {
+    Frame frame;
+    frame.append(Messages::WRONG);
+    frame.appendNumber(trickNumber);
+    frame.appendEnd();
+    return frame;
+}
+
+Frame getTakenFrame(int trickNumber, std::span<const Card> cards, TABLE_PLACE taker) {
+    Frame frame;
+    frame.append(Messages::TAKEN);
+    frame.appendNumber(trickNumber);
+    frame.appendCards(cards);
+    frame.append(tablePlaceToChar(static_cast<int>(taker)));
+    frame.appendEnd();
+    return frame;
+}
+
+/// @brief Which is SCORE or TOTAL.
+Frame getResultsFrame(const std::string &which, const std::map<TABLE_PLACE, uint64_t> &scores) {
+    Frame frame;
+    frame.append(which);
+    for (const auto &[place, score] : scores) {
+        frame.append(tablePlaceToChar(static_cast<int>(place)));
+        frame.appendNumber(score);
+    }
+    frame.appendEnd();
+    return frame;
+}
+
+/// BINARY PROTOCOL ///
+
+/// @brief Returns true if number is a trick number, both when encoding text and reading bytes.
+static bool isTrickNumber(int64_t number) {
+    return number >= 1 and number <= Constants::TRICK_NUMBER;
+}
+
+/// @brief Returns true if byte is a table place.
+static bool isPlace(char byte) {
+    return byte >= 0 and byte < Constants::PLAYERS_NUMBER;
+}
+
+/// @brief Appends integer 7 bits per byte, so that small ones take a single byte.
+static void appendVarint(Frame &frame, uint64_t number) {
+    while (number >= BinaryConstants::VARINT_MORE) {
+        frame.append(static_cast<char>(number | BinaryConstants::VARINT_MORE));
+        number >>= BinaryConstants::VARINT_BITS;
+    }
+    frame.append(static_cast<char>(number));
+}
+
+/// @brief Reads integer written by appendVarint at position, moving position past it. Returns
+/// false if payload ends inside it or it does not fit.
+static bool readVarint(std::string_view payload, size_t &position, uint64_t &number) {
+    number = 0;
+    for (int shift = 0; position < payload.size() and shift < 64;
+         shift += BinaryConstants::VARINT_BITS) {
+        auto byte = static_cast<uint8_t>(payload[position++]);
+        if (shift == 63 and byte > 1) {
+            return false; // Only lowest bit of tenth byte fits, and no byte may follow it.
+        }
+        number |= static_cast<uint64_t>(byte & ~BinaryConstants::VARINT_MORE) << shift;
+        if (not(byte & BinaryConstants::VARINT_MORE)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @brief Starts binary message of given type, its payload length is filled in by
+/// finishBinaryFrame.
+static Frame startBinaryFrame(BINARY_TYPE type) {
+    Frame frame;
+    frame.append(static_cast<char>(type));
+    frame.append('\0');
+    return frame;
+}
+
+/// @brief Fills in payload length of binary message started by startBinaryFrame.
+static void finishBinaryFrame(Frame &frame) {
+    frame.data[1] = static_cast<char>(frame.length - BinaryConstants::HEADER_SIZE);
+}
+
+/// @brief Appends id of every card.
+static void appendBinaryCards(Frame &frame, std::span<const Card> cards) {
+    for (const auto &card : cards) {
+        frame.append(static_cast<char>(getCardId(card)));
+    }
+}
+
+Frame getBinaryDealFrame(HAND_TYPE handType, TABLE_PLACE firstPlayer, std::span<const Card> cards) {
+    Frame frame = startBinaryFrame(BINARY_TYPE::DEAL);
+    frame.append(static_cast<char>(handType));
+    frame.append(static_cast<char>(firstPlayer));
+    appendBinaryCards(frame, cards);
+    finishBinaryFrame(frame);
+    return frame;
+}
+
+Frame getBinaryTrickFrame(int trickNumber, std::span<const Card> cards) {
+    Frame frame = startBinaryFrame(BINARY_TYPE::TRICK);
+    frame.append(static_cast<char>(trickNumber));
+    appendBinaryCards(frame, cards);
+    finishBinaryFrame(frame);
+    return frame;
+}
+
+Frame getBinaryTakenFrame(int trickNumber, std::span<const Card> cards, TABLE_PLACE taker) {
+    Frame frame = startBinaryFrame(BINARY_TYPE::TAKEN);
+    frame.append(static_cast<char>(trickNumber));
+    appendBinaryCards(frame, cards);
+    frame.append(static_cast<char>(taker));
+    finishBinaryFrame(frame);
+    return frame;
+}
+
+/// @brief Parses decimal number that makes up whole text, returns false if it is not one.
+static bool parseNumber(std::string_view text, uint64_t &number) {
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), number);
+    return not text.empty() and error == std::errc() and end == text.data() + text.size();
+}
+
+/// @brief Appends ids of cards written one after another, returns false if text is not a list
+/// of cards.
+static bool appendCardIds(Frame &frame, std::string_view cards) {
+    size_t cardStart = 0;
+    for (size_t i = 0; i < cards.size(); i++) {
+        if (CardConstants::COLOR_FROM_CHAR[static_cast<unsigned char>(cards[i])] < 0) {
+            continue;
+        }
+
+        Card card;
+        if (not setCardFromStr(card, cards.substr(cardStart, i - cardStart + 1))) {
+            return false;
+        }
+        frame.append(static_cast<char>(getCardId(card)));
+        cardStart = i + 1;
+    }
+
+    return cardStart == cards.size();
+}
+
+/// @brief Appends trick number and ids of cards following it. Number has one or two digits and
+/// only one split leaves a valid list of cards, e.g. 1010H is trick 10 and 10H.
+static bool appendTrickAndCards(Frame &frame, std::string_view text) {
+    for (size_t digits = 1; digits <= 2 and digits <= text.size(); digits++) {
+        uint64_t trickNumber;
+        if (not parseNumber(text.substr(0, digits), trickNumber) or
+            not isTrickNumber(trickNumber)) {
+            continue;
+        }
+
+        Frame attempt = frame;
+        attempt.append(static_cast<char>(trickNumber));
+        if (appendCardIds(attempt, text.substr(digits))) {
+            frame = attempt;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/// @brief Appends place and score for every place, e.g. N0E4S3W6.
+static bool appendScores(Frame &frame, std::string_view text) {
+    size_t start = 0;
+    while (start < text.size()) {
+        int place = CardConstants::PLACE_FROM_CHAR[static_cast<unsigned char>(text[start])];
+        size_t end = start + 1;
+        while (end < text.size() and text[end] >= '0' and text[end] <= '9') {
+            end++;
+        }
+
+        uint64_t score;
+        if (place < 0 or not parseNumber(text.substr(start + 1, end - start - 1), score)) {
+            return false;
+        }
+        frame.append(static_cast<char>(place));
+        appendVarint(frame, score);
+        start = end;
+    }
+
+    return true;
+}
+
+/// @brief Returns true if text starts with given prefix and cuts it off.
+static bool cutPrefix(std::string_view &text, const std::string &prefix) {
+    if (not text.starts_with(prefix)) {
+        return false;
+    }
+    text.remove_prefix(prefix.size());
+    return true;
+}
+
+Frame encodeBinaryFrame(std::string_view message) {
+    Frame frame;
+    if (not message.ends_with(Messages::END_OF_MESSAGE)) {
+        return frame;
+    }
+    std::string_view text = message.substr(0, message.size() - Messages::END_OF_MESSAGE.size());
+
+    frame.append('\0'); // Type and length are filled in once payload is known.
+    frame.append('\0');
+    bool encoded = false;
+    BINARY_TYPE type = BINARY_TYPE::BUSY;
+
+    if (cutPrefix(text, Messages::BUSY)) {
+        uint8_t mask = 0;
+        encoded = true;
+        for (char c : text) {
+            int place = CardConstants::PLACE_FROM_CHAR[static_cast<unsigned char>(c)];
+            encoded = encoded and place >= 0;
+            mask |= place >= 0 ? 1U << place : 0;
+        }
+        frame.append(static_cast<char>(mask));
+    } else if (cutPrefix(text, Messages::QUEUE)) {
+        type = BINARY_TYPE::QUEUE;
+        uint64_t position;
+        encoded = parseNumber(text, position);
+        if (encoded) {
+            appendVarint(frame, position);
+        }
+    } else if (cutPrefix(text, Messages::DEAL)) {
+        type = BINARY_TYPE::DEAL;
+        if (text.size() >= 2) {
+            int handType = CardConstants::HAND_TYPE_FROM_CHAR[static_cast<unsigned char>(text[0])];
+            int place = CardConstants::PLACE_FROM_CHAR[static_cast<unsigned char>(text[1])];
+            frame.append(static_cast<char>(handType));
+            frame.append(static_cast<char>(place));
+            encoded = handType >= 0 and place >= 0 and appendCardIds(frame, text.substr(2));
+        }
+    } else if (cutPrefix(text, Messages::TRICK)) {
+        type = BINARY_TYPE::TRICK;
+        encoded = appendTrickAndCards(frame, text);
+    } else if (cutPrefix(text, Messages::WRONG)) {
+        type = BINARY_TYPE::WRONG;
+        uint64_t trickNumber;
+        encoded = parseNumber(text, trickNumber) and isTrickNumber(trickNumber);
+        if (encoded) {
+            frame.append(static_cast<char>(trickNumber));
+        }
+    } else if (cutPrefix(text, Messages::TAKEN)) {
+        type = BINARY_TYPE::TAKEN;
+        if (not text.empty()) {
+            int place = CardConstants::PLACE_FROM_CHAR[static_cast<unsigned char>(text.back())];
+            encoded = place >= 0 and appendTrickAndCards(frame, text.substr(0, text.size() - 1));
+            if (encoded) {
+                frame.append(static_cast<char>(place));
+            }
+        }
+    } else if (cutPrefix(text, Messages::SCORE)) {
+        type = BINARY_TYPE::SCORE;
+        encoded = appendScores(frame, text);
+    } else if (cutPrefix(text, Messages::TOTAL)) {
+        type = BINARY_TYPE::TOTAL;
+        encoded = appendScores(frame, text);
+    }
+
+    if (not encoded or frame.length >= FrameConstants::CAPACITY) {
+        return Frame();
+    }
+
+    frame.data[0] = static_cast<char>(type);
+    finishBinaryFrame(frame);
+    return frame;
+}
+
+/// @brief Reads card ids into cards, returns false if some id is not a card.
+static bool readCards(std::string_view ids, std::vector<Card> &cards) {
+    for (char id : ids) {
+        auto cardId = static_cast<uint8_t>(id);
+        if (cardId >= CardConstants::DECK_SIZE) {
+            return false;
+        }
+        cards.push_back({static_cast<CARD_COLOR>(cardId / Constants::CARDS_NUMBER),
+                         cardId % Constants::CARDS_NUMBER + CardConstants::LOWEST_VALUE});
+    }
+    return true;
+}
+
+bool readCardsMessage(std::string_view message, CardsMessage &cardsMessage) {
+    cardsMessage.parsed = false;
+    cardsMessage.cards.clear();
+    if (message.size() < BinaryConstants::HEADER_SIZE or
+        binaryMessageLen(message) != message.size()) {
+        return false;
+    }
+
+    cardsMessage.type = static_cast<BINARY_TYPE>(message[0]);
+    std::string_view payload = message.substr(BinaryConstants::HEADER_SIZE);
+
+    switch (cardsMessage.type) {
+    case BINARY_TYPE::DEAL:
+        if (payload.size() < 2 or payload[0] < static_cast<int>(HAND_TYPE::DEFAULT) or
+            payload[0] > static_cast<int>(HAND_TYPE::BANDIT) or not isPlace(payload[1])) {
+            return false;
+        }
+        cardsMessage.handType = static_cast<HAND_TYPE>(payload[0]);
+        cardsMessage.place = static_cast<TABLE_PLACE>(payload[1]);
+        payload.remove_prefix(2);
+        break;
+    case BINARY_TYPE::TRICK:
+        if (payload.empty() or not isTrickNumber(payload[0])) {
+            return false;
+        }
+        cardsMessage.trickNumber = payload[0];
+        payload.remove_prefix(1);
+        break;
+    case BINARY_TYPE::TAKEN:
+        if (payload.size() < 2 or not isTrickNumber(payload[0]) or not isPlace(payload.back())) {
+            return false;
+        }
+        cardsMessage.trickNumber = payload[0];
+        cardsMessage.place = static_cast<TABLE_PLACE>(payload.back());
+        payload = payload.substr(1, payload.size() - 2);
+        break;
+    default:
+        return false;
+    }
+
+    cardsMessage.parsed = readCards(payload, cardsMessage.cards);
+    return cardsMessage.parsed;
+}
+
+Frame getCardsMessageFrame(const CardsMessage &cardsMessage) {
+    switch (cardsMessage.type) {
+    case BINARY_TYPE::DEAL:
+        return getDealFrame(cardsMessage.handType, cardsMessage.place, cardsMessage.cards);
+    case BINARY_TYPE::TRICK:
+        return getTrickFrame(cardsMessage.trickNumber, cardsMessage.cards);
+    case BINARY_TYPE::TAKEN:
+        return getTakenFrame(cardsMessage.trickNumber, cardsMessage.cards, cardsMessage.place);
+    default:
+        return Frame();
+    }
+}
+
+/// @brief Decodes place and score for every place into text frame.
+static Frame decodeScores(const std::string &which, std::string_view payload) {
+    Frame frame;
+    frame.append(which);
+    size_t position = 0;
+    while (position < payload.size()) {
+        char place = payload[position++];
+        uint64_t score;
+        if (not isPlace(place) or not readVarint(payload, position, score)) {
+            return Frame();
+        }
+        frame.append(tablePlaceToChar(place));
+        frame.appendNumber(score);
+    }
+    frame.appendEnd();
+    return frame;
+}
+
+Frame decodeBinaryFrame(std::string_view message) {
+    if (message.size() < BinaryConstants::HEADER_SIZE or
+        binaryMessageLen(message) != message.size()) {
+        return Frame();
+    }
+
+    auto type = static_cast<BINARY_TYPE>(message[0]);
+    std::string_view payload = message.substr(BinaryConstants::HEADER_SIZE);
+
+    switch (type) {
+    case BINARY_TYPE::BUSY:
+        if (payload.size() == 1) {
+            return getBusyFrame(static_cast<uint8_t>(payload[0]));
+        }
+        break;
+    case BINARY_TYPE::QUEUE: {
+        size_t position = 0;
+        uint64_t queuePosition;
+        if (readVarint(payload, position, queuePosition) and position == payload.size()) {
+            return getQueueFrame(static_cast<int>(queuePosition));
+        }
+        break;
+    }
+    case BINARY_TYPE::DEAL:
+    case BINARY_TYPE::TRICK:
+    case BINARY_TYPE::TAKEN: {
+        CardsMessage cardsMessage;
+        if (readCardsMessage(message, cardsMessage)) {
+            return getCardsMessageFrame(cardsMessage);
+        }
+        break;
+    }
+    case BINARY_TYPE::WRONG:
+        if (payload.size() == 1 and isTrickNumber(payload[0])) {
+            return getWrongFrame(payload[0]);
+        }
+        break;
+    case BINARY_TYPE::SCORE:
+        return decodeScores(Messages::SCORE, payload);
+    case BINARY_TYPE::TOTAL:
+        return decodeScores(Messages::TOTAL, payload);
+    }
+
+    return Frame();
+}
+
+std::string encodeBinary(std::string_view messages) {
+    std::string encoded;
+    size_t start = 0, end;
+    while ((end = messages.find(Messages::END_OF_MESSAGE, start)) != std::string_view::npos) {
+        end += Messages::END_OF_MESSAGE.size();
+        Frame frame = encodeBinaryFrame(messages.substr(start, end - start));
+        if (frame.length == 0) {
+            return {};
+        }
+        encoded += frame.view();
+        start = end;
+    }
+    return encoded;
+}
+
+std::string decodeBinary(std::string_view messages) {
+    std::string decoded;
+    size_t messageLen;
+    while ((messageLen = binaryMessageLen(messages)) > 0) {
+        decoded += decodeBinaryFrame(messages.substr(0, messageLen)).view();
+        messages.remove_prefix(messageLen);
+    }
+    return decoded;
+}
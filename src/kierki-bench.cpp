@@ -0,0 +1,639 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <fstream>
+#include <functional>
+#include <netinet/in.h>
+#include <new>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "common/ShmChannel.h"
+#include "common/common.h"
+#include "server/serwer-common.h"
+#include "server/serwer-communicator.h"
+#include "err/err.h"
+
+/// COUNTING ALLOCATOR ///
+
+static std::atomic<uint64_t> allocationCount{0};
+
+void *operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size == 0 ? 1 : size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    free(ptr);
+}
+
+/// BENCHMARK HARNESS ///
+
+namespace BenchConstants {
+const int DEFAULT_MIN_TIME_MS = 200;
+const int WARMUP_ITERATIONS = 1000;
+const uint64_t BATCH_SIZE = 1024;
+const uint64_t SOCKET_BATCH_SIZE = 8; // Round trip stalled by Nagle takes tens of milliseconds.
+} // namespace BenchConstants
+
+struct BenchResult {
+    std::string name;
+    uint64_t iterations;
+    double nsPerOp;
+    double allocsPerOp;
+};
+
+struct BenchArguments {
+    char *jsonFile = nullptr;
+    char *label = nullptr;
+    char *filter = nullptr;
+    int minTimeMs = BenchConstants::DEFAULT_MIN_TIME_MS;
+};
+
+/// @brief Prevents compiler from optimizing away computed value.
+template <typename T> static void doNotOptimize(T const &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// @brief Runs operation in batches until minimal time passes and returns measured result.
+static BenchResult runBenchmark(const std::string &name, const std::function<void()> &operation,
+                                int minTimeMs, uint64_t batchSize) {
+    for (uint64_t i = 0; i < std::min<uint64_t>(BenchConstants::WARMUP_ITERATIONS, batchSize);
+         i++) {
+        operation();
+    }
+
+    uint64_t iterations = 0;
+    uint64_t allocations = allocationCount.load(std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::milliseconds(minTimeMs);
+    auto end = start;
+
+    do {
+        for (uint64_t i = 0; i < batchSize; i++) {
+            operation();
+        }
+        iterations += batchSize;
+        end = std::chrono::steady_clock::now();
+    } while (end < deadline);
+
+    allocations = allocationCount.load(std::memory_order_relaxed) - allocations;
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    return {name, iterations, (double)elapsed / (double)iterations,
+            (double)allocations / (double)iterations};
+}
+
+/// BENCHMARK FIXTURES ///
+
+/// @brief Returns server hand with given card lines dealt to N, E, S and W.
+static ServerHand makeServerHand(HAND_TYPE handType, const std::vector<std::string> &cardLines) {
+    ServerHand hand = ServerHand();
+    hand.handType = handType;
+    hand.previousTrickTaker = TABLE_PLACE::N;
+    hand.currentClient = TABLE_PLACE::N;
+
+    int placeInt = 0;
+    for (const auto &line : cardLines) {
+        auto place = static_cast<TABLE_PLACE>(placeInt++);
+        std::vector<Card> cards = parseCardsVector(line, 0, line.size()).second;
+        hand.playerCards[static_cast<int>(place)] = getCardsMask(cards);
+        hand.playerScores[place] = 0;
+    }
+
+    return hand;
+}
+
+/// @brief Returns server status with a single hand from sample game.
+static ServerStatus makeServerStatus() {
+    ServerStatus serverStatus;
+    serverStatus.hands.emplace_back(makeServerHand(
+        HAND_TYPE::BANDIT, {"2H3D4C5S6H7D8C9S10HJDQCKSAH", "2S3H4D5C6S7H8D9C10SJCQHKDAS",
+                            "2C3S4H5D6C7S8H9D10CJSQDKHAC", "2D3C4S5H6D7C8S9H10DJHQSKCAD"}));
+
+    for (int i = 0; i < Constants::PLAYERS_NUMBER; i++) {
+        auto place = static_cast<TABLE_PLACE>(i);
+        serverStatus.hands[0].playerScores[place] = 12 * i + 3;
+        serverStatus.playerTotalScores[place] = 1234 * i + 56;
+    }
+
+    return serverStatus;
+}
+
+/// @brief Connected loopback TCP sockets, server end plays croupier and client end plays player.
+struct LoopbackPair {
+    int serverFd = -1;
+    int clientFd = -1;
+
+    LoopbackPair() = default;
+    LoopbackPair(const LoopbackPair &) = delete;
+    LoopbackPair &operator=(const LoopbackPair &) = delete;
+
+    ~LoopbackPair() {
+        close(serverFd);
+        close(clientFd);
+    }
+};
+
+/// @brief Connects loopback pair with given options applied to both ends.
+static void connectLoopbackPair(LoopbackPair &pair, const SocketOptions &socketOptions) {
+    int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addressLen = sizeof(address);
+
+    if (listenFd < 0 or bind(listenFd, (struct sockaddr *)&address, addressLen) < 0 or
+        listen(listenFd, 1) < 0 or
+        getsockname(listenFd, (struct sockaddr *)&address, &addressLen) < 0) {
+        sysFatal("loopback listen");
+    }
+
+    pair.clientFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (pair.clientFd < 0 or connect(pair.clientFd, (struct sockaddr *)&address, addressLen) < 0) {
+        sysFatal("loopback connect");
+    }
+
+    pair.serverFd = accept(listenFd, nullptr, nullptr);
+    if (pair.serverFd < 0) {
+        sysFatal("loopback accept");
+    }
+    close(listenFd);
+
+    applySocketOptions(pair.serverFd, socketOptions);
+    applySocketOptions(pair.clientFd, socketOptions);
+}
+
+/// @brief Connects pair over unix socket, like a bot on the same host as server.
+static void connectUnixPair(LoopbackPair &pair) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) {
+        sysFatal("socketpair");
+    }
+    pair.serverFd = fds[0];
+    pair.clientFd = fds[1];
+}
+
+/// @brief Reads exactly len bytes, turning quick ACK on again like event loops do.
+static void readExactly(int socketFd, char *buffer, size_t len,
+                        const SocketOptions &socketOptions) {
+    size_t readTotal = 0;
+    while (readTotal < len) {
+        ssize_t readLen = read(socketFd, buffer + readTotal, len - readTotal);
+        if (readLen <= 0) {
+            sysFatal("loopback read");
+        }
+        readTotal += readLen;
+        rearmQuickAck(socketFd, socketOptions);
+    }
+}
+
+/// @brief One trick as seen on the wire: croupier writes TAKEN and TRICK one after another, player
+/// answers with its card once both arrived.
+static void playTrickRoundTrip(LoopbackPair &pair, const SocketOptions &socketOptions) {
+    static const std::string taken = "TAKEN1310HQHKHJHN\r\n";
+    static const std::string trick = "TRICK1\r\n";
+    static const std::string answer = "TRICK12H\r\n";
+    static char buffer[64];
+
+    if (socketOptions.cork) {
+        sendMessageMore(pair.serverFd, taken.data(), taken.size());
+    } else {
+        sendMessage(pair.serverFd, taken.data(), taken.size());
+    }
+    sendMessage(pair.serverFd, trick.data(), trick.size());
+    readExactly(pair.clientFd, buffer, taken.size() + trick.size(), socketOptions);
+
+    sendMessage(pair.clientFd, answer.data(), answer.size());
+    readExactly(pair.serverFd, buffer, answer.size(), socketOptions);
+}
+
+/// @brief Waits for input from shared memory like event loops do: spins first and sleeps in poll
+/// on doorbell socket only if nothing came. Returns false if it gave up after timeout.
+static bool waitForShm(ShmChannel &channel, int socketFd, int timeout) {
+    bool sleeps = not channel.waitForInput(ShmConstants::CLIENT_SPIN_MICROS) and channel.setIdle();
+    pollfd doorbell = {socketFd, POLLIN, 0};
+    if (sleeps) {
+        poll(&doorbell, 1, timeout);
+    }
+    channel.setBusy(doorbell.revents & POLLIN);
+    return channel.hasInput();
+}
+
+/// @brief Reads exactly len bytes from shared memory.
+static void receiveExactly(ShmChannel &channel, int socketFd, char *buffer, size_t len) {
+    size_t readTotal = 0;
+    while (readTotal < len) {
+        waitForShm(channel, socketFd, -1);
+        ssize_t readLen = channel.receive(buffer + readTotal, len - readTotal);
+        if (readLen == 0) {
+            fatal("shared memory closed");
+        }
+        if (readLen > 0) {
+            readTotal += readLen;
+        }
+    }
+}
+
+/// @brief Server and bot ends of shared memory over a unix socket pair. Bot answers every trick
+/// from its own thread, so round trip crosses cores like between two processes.
+struct ShmPair {
+    LoopbackPair sockets;
+    ShmChannel serverChannel;
+    ShmChannel clientChannel;
+    std::atomic<bool> stopped{false};
+    std::thread bot;
+
+    ShmPair() {
+        connectUnixPair(sockets);
+        if (fcntl(sockets.serverFd, F_SETFL, O_NONBLOCK) or
+            fcntl(sockets.clientFd, F_SETFL, O_NONBLOCK)) {
+            sysFatal("fcntl");
+        }
+        if (not serverChannel.create(sockets.serverFd) or
+            not clientChannel.attach(dup(serverChannel.getMemFd()), sockets.clientFd, false)) {
+            sysFatal("shared memory");
+        }
+
+        bot = std::thread([this] {
+            static const std::string answer = "TRICK12H\r\n";
+            const size_t expected = std::string("TAKEN1310HQHKHJHN\r\nTRICK1\r\n").size();
+            char buffer[64];
+            size_t readTotal = 0;
+            while (not stopped.load(std::memory_order_relaxed)) {
+                // Bot wakes up now and then to notice that benchmark is over.
+                if (not waitForShm(clientChannel, sockets.clientFd, 10)) {
+                    continue;
+                }
+                readTotal += std::max<ssize_t>(clientChannel.receive(buffer, sizeof(buffer)), 0);
+                if (readTotal == expected) {
+                    readTotal = 0;
+                    clientChannel.send(answer.data(), answer.size());
+                }
+            }
+        });
+    }
+
+    ~ShmPair() {
+        stopped = true;
+        bot.join();
+        serverChannel.release();
+        clientChannel.release();
+    }
+};
+
+/// @brief Same trick as playTrickRoundTrip, handed to bot over shared memory.
+static void playShmTrickRoundTrip(ShmPair &pair) {
+    static const std::string taken = "TAKEN1310HQHKHJHN\r\n";
+    static const std::string trick = "TRICK1\r\n";
+    static char buffer[64];
+
+    pair.serverChannel.send(taken.data(), taken.size());
+    pair.serverChannel.send(trick.data(), trick.size());
+    receiveExactly(pair.serverChannel, pair.sockets.serverFd, buffer,
+                   std::string("TRICK12H\r\n").size());
+}
+
+/// BENCHMARKS ///
+
+static std::vector<BenchResult> runAll(const BenchArguments &benchArguments) {
+    std::vector<BenchResult> results;
+
+    auto selected = [&](const std::string &name) {
+        return benchArguments.filter == nullptr or
+               name.find(benchArguments.filter) != std::string::npos;
+    };
+
+    auto add = [&](const std::string &name, const std::function<void()> &operation,
+                   uint64_t batchSize = BenchConstants::BATCH_SIZE) {
+        if (not selected(name)) {
+            return;
+        }
+        results.emplace_back(runBenchmark(name, operation, benchArguments.minTimeMs, batchSize));
+    };
+
+    const std::string tenCard = "10H";
+    const std::string queenCard = "QS";
+    add("setCardFromStr/10H", [&] {
+        Card card = Card();
+        doNotOptimize(setCardFromStr(card, tenCard));
+        doNotOptimize(card);
+    });
+    add("setCardFromStr/QS", [&] {
+        Card card = Card();
+        doNotOptimize(setCardFromStr(card, queenCard));
+        doNotOptimize(card);
+    });
+
+    const std::string dealMessage = "DEAL7N2H3D4C5S6H7D8C9S10HJDQCKSAH\r\n";
+    add("parseCardsVector/deal13", [&] {
+        auto parsed = parseCardsVector(dealMessage, 6, dealMessage.size() - 2);
+        doNotOptimize(parsed.first);
+    });
+
+    std::string trickMessage = "TRICK1010H\r\n";
+    std::string shortTrickMessage = "TRICK5QS\r\n";
+    add("getTrickNumber/TRICK1010H", [&] {
+        doNotOptimize(getTrickNumber(trickMessage, 5));
+    });
+    add("getTrickNumber/TRICK5QS", [&] {
+        doNotOptimize(getTrickNumber(shortTrickMessage, 5));
+    });
+
+    add("canTrickBeParsed/TRICK1010H", [&] {
+        doNotOptimize(canTrickBeParsed(trickMessage));
+    });
+
+    ServerStatus trickStatus = makeServerStatus();
+    const std::string placedTrick = "TRICK12H\r\n";
+    Card placedCard = Card();
+    setCardFromStr(placedCard, "2H");
+    add("parseTrickServer/valid", [&] {
+        doNotOptimize(parseTrickServer(placedTrick, trickStatus, TABLE_PLACE::N));
+
+        // Put the card back so that every iteration parses the same state.
+        ServerHand &hand = trickStatus.hands[0];
+        hand.playerCards[static_cast<int>(TABLE_PLACE::N)] |= 1ULL << getCardId(placedCard);
+        hand.currentlyPlacedCards.clear();
+    });
+
+    ServerHand takenHand = makeServerHand(HAND_TYPE::BANDIT, {"", "", "", ""});
+    takenHand.currentTrick = 7;
+    takenHand.currentlyPlacedCards = parseCardsVector("10HQHKHJH", 0, 9).second;
+    add("getTakenMessage/bandit", [&] {
+        takenHand.previousTrickTaker = TABLE_PLACE::N;
+        Frame binaryTaken;
+        Frame taken = getTakenMessage(takenHand, binaryTaken);
+        doNotOptimize(taken);
+        doNotOptimize(binaryTaken);
+    });
+
+    uint32_t packedTrick = packTrick(takenHand.currentlyPlacedCards);
+    add("getTrickWinner/hearts", [&] {
+        doNotOptimize(getTrickWinner(packedTrick));
+    });
+
+    uint64_t legalHand = trickStatus.hands[0].playerCards[static_cast<int>(TABLE_PLACE::N)];
+    add("getLegalMoves/follow", [&] {
+        doNotOptimize(getLegalMoves(legalHand, getCardId(placedCard)));
+    });
+
+    ServerStatus resultsStatus = makeServerStatus();
+    add("getResultsMessage/SCORE", [&] {
+        Frame score = getResultsMessage(resultsStatus, Messages::SCORE);
+        doNotOptimize(score);
+    });
+    add("getResultsMessage/TOTAL", [&] {
+        Frame total = getResultsMessage(resultsStatus, Messages::TOTAL);
+        doNotOptimize(total);
+    });
+
+    ReadBuffer readBuffer = ReadBuffer();
+    const std::string twoMessages = "TRICK1010H\r\nTRICK5QS\r\n";
+    add("ReadBuffer::popFirstNetworkMessage", [&] {
+        readBuffer.appendRead(twoMessages);
+        std::string first = readBuffer.popFirstNetworkMessage();
+        std::string second = readBuffer.popFirstNetworkMessage();
+        doNotOptimize(first.data());
+        doNotOptimize(second.data());
+    });
+
+    // Per message cost of each protocol. DEAL, TRICK and TAKEN are built and read in binary
+    // directly, other messages are encoded from text and decoded to it.
+    const std::pair<std::string, std::string> protocolMessages[] = {
+        {"DEAL", dealMessage},
+        {"TRICK", trickMessage},
+        {"TAKEN", "TAKEN1310HQHKHJHN\r\n"},
+        {"TOTAL", "TOTALN4E3S4W15\r\n"},
+    };
+    for (const auto &[name, message] : protocolMessages) {
+        const std::string binaryMessage(encodeBinaryFrame(message).view());
+
+        ReadBuffer textBuffer = ReadBuffer();
+        add("protocol/" + name + "/textRead", [&] {
+            textBuffer.appendRead(message);
+            std::string read = textBuffer.popFirstNetworkMessage();
+            doNotOptimize(read.data());
+        });
+        ReadBuffer binaryBuffer = ReadBuffer();
+        binaryBuffer.binary = true;
+        add("protocol/" + name + "/binaryRead", [&] {
+            binaryBuffer.appendRead(binaryMessage);
+            Frame read = decodeBinaryFrame(binaryBuffer.popFirstNetworkMessage());
+            doNotOptimize(read);
+        });
+        add("protocol/" + name + "/binaryEncode", [&] {
+            Frame encoded = encodeBinaryFrame(message);
+            doNotOptimize(encoded);
+        });
+    }
+
+    CardsMessage cardsMessage;
+    for (const auto &[name, message] : protocolMessages) {
+        const std::string binaryMessage(encodeBinaryFrame(message).view());
+        if (not readCardsMessage(binaryMessage, cardsMessage)) {
+            continue;
+        }
+
+        const CardsMessage built = cardsMessage;
+        ReadBuffer binaryBuffer = ReadBuffer();
+        binaryBuffer.binary = true;
+        add("protocol/" + name + "/binaryReadCards", [&] {
+            binaryBuffer.appendRead(binaryMessage);
+            doNotOptimize(readCardsMessage(binaryBuffer.popFirstNetworkMessage(), cardsMessage));
+        });
+        add("protocol/" + name + "/binaryBuild", [&] {
+            Frame frame;
+            if (built.type == BINARY_TYPE::DEAL) {
+                frame = getBinaryDealFrame(built.handType, built.place, built.cards);
+            } else if (built.type == BINARY_TYPE::TRICK) {
+                frame = getBinaryTrickFrame(built.trickNumber, built.cards);
+            } else {
+                frame = getBinaryTakenFrame(built.trickNumber, built.cards, built.place);
+            }
+            doNotOptimize(frame);
+        });
+    }
+
+    WriteBuffer writeBuffer = WriteBuffer();
+    const std::string takenMessage = "TAKEN1310HQHKHJHN\r\n";
+    add("WriteBuffer::wroteWholeMessage/whole", [&] {
+        writeBuffer.appendMessage(takenMessage);
+        doNotOptimize(writeBuffer.wroteWholeMessage((int)takenMessage.size()));
+    });
+    add("WriteBuffer::wroteWholeMessage/partial", [&] {
+        writeBuffer.appendMessage(takenMessage);
+        doNotOptimize(writeBuffer.wroteWholeMessage(7));
+        doNotOptimize(writeBuffer.wroteWholeMessage((int)takenMessage.size() - 7));
+    });
+
+    // Latency of a trick round trip over loopback, from Nagle's algorithm to all options on, and
+    // over unix socket. Sockets and bot thread are set up only for benchmarks that pass filter.
+    const std::pair<std::string, SocketOptions> socketVariants[] = {
+        {"nagle", {false, false, false}},
+        {"nodelay", {true, false, false}},
+        {"nodelay+quickack", {true, true, false}},
+        {"nodelay+quickack+cork", {true, true, true}},
+    };
+    for (const auto &[variant, socketOptions] : socketVariants) {
+        const std::string name = "socket/trickRoundTrip/" + variant;
+        if (not selected(name)) {
+            continue;
+        }
+
+        LoopbackPair pair;
+        connectLoopbackPair(pair, socketOptions);
+        add(
+            name, [&] { playTrickRoundTrip(pair, socketOptions); },
+            BenchConstants::SOCKET_BATCH_SIZE);
+    }
+
+    const std::string unixName = "socket/trickRoundTrip/unix";
+    if (selected(unixName)) {
+        const SocketOptions unixOptions = {false, false, false};
+        LoopbackPair unixPair;
+        connectUnixPair(unixPair);
+        add(
+            unixName, [&] { playTrickRoundTrip(unixPair, unixOptions); },
+            BenchConstants::SOCKET_BATCH_SIZE);
+    }
+
+    const std::string shmName = "shm/trickRoundTrip/botThread";
+    if (selected(shmName)) {
+        ShmPair shmPair;
+        add(
+            shmName, [&] { playShmTrickRoundTrip(shmPair); }, BenchConstants::SOCKET_BATCH_SIZE);
+    }
+
+    return results;
+}
+
+/// OUTPUT ///
+
+/// @brief Returns string with characters escaped for JSON.
+static std::string jsonEscape(const std::string &str) {
+    std::string escaped;
+    for (char c : str) {
+        if (c == '"' or c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+/// @brief Prints results as a table to standard output.
+static void printResults(const std::vector<BenchResult> &results) {
+    std::cout << std::left << std::setw(42) << "benchmark" << std::right << std::setw(14)
+              << "iterations" << std::setw(12) << "ns/op" << std::setw(12) << "allocs/op"
+              << std::endl;
+
+    for (const auto &result : results) {
+        std::cout << std::left << std::setw(42) << result.name << std::right << std::setw(14)
+                  << result.iterations << std::setw(12) << std::fixed << std::setprecision(2)
+                  << result.nsPerOp << std::setw(12) << result.allocsPerOp << std::endl;
+    }
+}
+
+/// @brief Writes results in JSON format to given file.
+static void writeJson(const BenchArguments &benchArguments,
+                      const std::vector<BenchResult> &results) {
+    std::ofstream jsonFile(benchArguments.jsonFile);
+    if (not jsonFile.is_open()) {
+        sysFatal("cannot open file %s", benchArguments.jsonFile);
+    }
+
+    std::string label = benchArguments.label == nullptr ? "" : benchArguments.label;
+    jsonFile << "{\n  \"label\": \"" << jsonEscape(label) << "\",\n  \"benchmarks\": [\n";
+
+    for (size_t i = 0; i < results.size(); i++) {
+        jsonFile << "    {\"name\": \"" << jsonEscape(results[i].name)
+                 << "\", \"iterations\": " << results[i].iterations << std::fixed
+                 << std::setprecision(3) << ", \"ns_per_op\": " << results[i].nsPerOp
+                 << ", \"allocs_per_op\": " << results[i].allocsPerOp << "}"
+                 << (i + 1 == results.size() ? "\n" : ",\n");
+    }
+
+    jsonFile << "  ]\n}\n";
+}
+
+/// @brief Function parses arguments passed by user.
+static void parseBenchInput(int argc, char **argv, BenchArguments &benchArguments) {
+    opterr = 0;
+    int c;
+
+    while ((c = getopt(argc, argv, "j:l:f:m:")) != -1)
+        switch (c) {
+        case 'j':
+            benchArguments.jsonFile = optarg;
+            break;
+        case 'l':
+            benchArguments.label = optarg;
+            break;
+        case 'f':
+            benchArguments.filter = optarg;
+            break;
+        case 'm':
+            benchArguments.minTimeMs = atoi(optarg);
+            if (benchArguments.minTimeMs <= 0) {
+                fatal("%s is not a valid time", optarg);
+            }
+            break;
+        case '?':
+            if (optopt == 'j' or optopt == 'l' or optopt == 'f' or optopt == 'm')
+                fatal("Option -%c requires an argument.\n", optopt);
+            fatal("Unknown option `-%c'.\n", optopt);
+        default:
+            sysFatal("getopt");
+        }
+}
+
+int main(int argc, char **argv) {
+    BenchArguments benchArguments = BenchArguments();
+    parseBenchInput(argc, argv, benchArguments);
+
+    std::vector<BenchResult> results = runAll(benchArguments);
+    printResults(results);
+
+    if (benchArguments.jsonFile != nullptr) {
+        writeJson(benchArguments, results);
+    }
+
+    return 0;
+}
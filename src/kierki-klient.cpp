@@ -6,6 +6,7 @@
 #include <inttypes.h>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <limits.h>
 #include <netdb.h>
 #include <netinet/in.h>
@@ -24,6 +25,7 @@
 #include "client/ClientPlayer.h"
 #include "client/klient-common.h"
 #include "client/klient-parser.h"
+#include "common/ShmChannel.h"
 #include "common/common.h"
 #include "err/err.h"
 
@@ -43,47 +45,82 @@ struct addrinfo *getAddrinfo(const char *host, ClientArguments &clientArguments)
     return addressResult;
 }
 
-int main(int argc, char **argv) {
-    ClientArguments clientArguments = ClientArguments();
-    parseUserInput(argc, argv, clientArguments);
+/// @brief Ends client if connect failed, unless it plays session which tries again later.
+int connectFailed(int socketFd, ClientArguments &clientArguments) {
+    if (not clientArguments.session) {
+        sysFatal("cannot connect to the server");
+    }
 
-    const char *host = clientArguments.host;
+    close(socketFd);
+    return Constants::ERROR_CODE;
+}
+
+/// @brief Returns socket connected to server listening on unix socket at given path.
+int connectToUnixServer(const char *path, ClientArguments &clientArguments,
+                        std::string &serverAddressStr, std::string &clientAddressStr) {
+    sockaddr_un serverAddress;
+    socklen_t serverAddressLen;
+    if (not setUnixAddress(serverAddress, serverAddressLen, path)) {
+        fatal("%s is not a valid unix socket path", path);
+    }
+
+    int socketFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socketFd < 0) {
+        sysFatal("cannot create a socket");
+    }
+
+    if (connect(socketFd, (struct sockaddr *)&serverAddress, serverAddressLen) < 0) {
+        return connectFailed(socketFd, clientArguments);
+    }
+
+    serverAddressStr = SocketConstants::UNIX_PREFIX + path;
+    clientAddressStr = getUnixPeerAddress(getpid());
+    return socketFd;
+}
+
+/// @brief Resolves server address, session does it only once for all its connections.
+void resolveTcpServer(ClientArguments &clientArguments, sockaddr_storage &serverAddress) {
     uint16_t port = readPort(clientArguments.port);
 
-    struct addrinfo *addressResult = getAddrinfo(host, clientArguments);
-    int aiFamily = addressResult->ai_family;
+    struct addrinfo *addressResult = getAddrinfo(clientArguments.host, clientArguments);
+    memset(&serverAddress, 0, sizeof(serverAddress));
+    if (addressResult->ai_family == AF_INET) {
+        setServerAddressIpv4(port, addressResult, (struct sockaddr_in *)&serverAddress);
+    } else {
+        setServerAddressIpv6(port, addressResult, (struct sockaddr_in6 *)&serverAddress);
+    }
+}
+
+/// @brief Returns socket connected to server over TCP, with socket options applied.
+int connectToTcpServer(ClientArguments &clientArguments, const sockaddr_storage &serverAddress,
+                       std::string &serverAddressStr, std::string &clientAddressStr) {
+    int aiFamily = serverAddress.ss_family;
 
     int socketFd = socket(aiFamily, SOCK_STREAM, 0);
     if (socketFd < 0) {
         sysFatal("cannot create a socket");
     }
 
-    std::string serverAddressStr;
-
     if (aiFamily == AF_INET) {
-        struct sockaddr_in serverAddressIpv4;
-        setServerAddressIpv4(port, addressResult, &serverAddressIpv4);
+        auto &serverAddressIpv4 = (const struct sockaddr_in &)serverAddress;
 
         if (connect(socketFd, (struct sockaddr *)&serverAddressIpv4,
                     (socklen_t)sizeof(serverAddressIpv4)) < 0) {
-            sysFatal("cannot connect to the server");
+            return connectFailed(socketFd, clientArguments);
         }
 
         serverAddressStr = getIpv4AndPortAddress(serverAddressIpv4);
     } else {
-        struct sockaddr_in6 serverAddressIpv6;
-        setServerAddressIpv6(port, addressResult, &serverAddressIpv6);
+        auto &serverAddressIpv6 = (const struct sockaddr_in6 &)serverAddress;
 
         if (connect(socketFd, (struct sockaddr *)&serverAddressIpv6,
                     (socklen_t)sizeof(serverAddressIpv6)) < 0) {
-            sysFatal("cannot connect to the server");
+            return connectFailed(socketFd, clientArguments);
         }
 
         serverAddressStr = getIpv6AndPortAddress(serverAddressIpv6);
     }
 
-    std::string clientAddressStr;
-
     if (aiFamily == AF_INET) {
         struct sockaddr_in clientAddress;
         socklen_t clientAddressLen = sizeof(clientAddress);
@@ -106,15 +143,151 @@ int main(int argc, char **argv) {
         clientAddressStr = getIpv6AndPortAddress(clientAddress);
     }
 
+    applySocketOptions(socketFd, clientArguments.socketOptions);
+
+    return socketFd;
+}
+
+/// @brief Asks server for shared memory transport and returns its memfd. Socket is still
+/// blocking, so reply is simply awaited. Session gets ERROR_CODE if server closed connection.
+int negotiateShm(int socketFd, ClientArguments &clientArguments,
+                 const std::string &serverAddressStr, const std::string &clientAddressStr) {
+    std::string request = Messages::SHM + Messages::END_OF_MESSAGE;
+    if (sendMessage(socketFd, request.c_str(), request.size()) != (ssize_t)request.size()) {
+        if (clientArguments.session) {
+            return Constants::ERROR_CODE;
+        }
+        sysFatal("write");
+    }
+    if (clientArguments.isAutomatic) {
+        display(clientAddressStr, serverAddressStr, request);
+    }
+
+    std::string reply;
+    int memFd = receiveMemFd(socketFd, reply);
+    if (memFd < 0 or reply != request) {
+        if (clientArguments.session) {
+            return Constants::ERROR_CODE;
+        }
+        fatal("server refused shared memory");
+    }
+    if (clientArguments.isAutomatic) {
+        display(serverAddressStr, clientAddressStr, reply);
+    }
+
+    return memFd;
+}
+
+/// @brief Returns player connected to server, or nullptr if session could not connect.
+std::unique_ptr<ClientPlayer> connectPlayer(ClientArguments &clientArguments,
+                                            const sockaddr_storage &serverAddress) {
+    const char *host = clientArguments.host;
+    std::string serverAddressStr, clientAddressStr;
+    int socketFd =
+        isUnixHost(host)
+            ? connectToUnixServer(host + SocketConstants::UNIX_PREFIX.size(), clientArguments,
+                                  serverAddressStr, clientAddressStr)
+            : connectToTcpServer(clientArguments, serverAddress, serverAddressStr,
+                                 clientAddressStr);
+    if (socketFd < 0) {
+        return nullptr;
+    }
+
+    int memFd = Constants::ERROR_CODE;
+    if (clientArguments.useShm) {
+        memFd = negotiateShm(socketFd, clientArguments, serverAddressStr, clientAddressStr);
+        if (memFd < 0) {
+            close(socketFd);
+            return nullptr;
+        }
+    }
+
     if (fcntl(socketFd, F_SETFL, O_NONBLOCK)) {
         sysFatal("fcntl");
     }
 
-    ClientPlayer clientPlayer =
-        ClientPlayer(socketFd, clientArguments, serverAddressStr, clientAddressStr);
-    clientPlayer.handleGame();
+    return std::make_unique<ClientPlayer>(socketFd, memFd, clientArguments, serverAddressStr,
+                                          clientAddressStr);
+}
+
+/// @brief Plays games one after another, reconnecting with backoff whenever server closes
+/// connection before game finished. Timing of every game and of whole session goes to stderr.
+void playSession(ClientArguments &clientArguments, const sockaddr_storage &serverAddress) {
+    int backoff = ClientConstants::SESSION_BACKOFF_MIN;
+    int failedAttempts = 0;
 
-    close(socketFd);
+    int connections = 0;
+    uint64_t connectMicros = 0;
+    auto gameStart = std::chrono::steady_clock::now();
+
+    int gamesPlayed = 0;
+    uint64_t minMicros = UINT64_MAX, maxMicros = 0;
+    auto sessionStart = gameStart;
+
+    while (clientArguments.games == 0 or gamesPlayed < clientArguments.games) {
+        auto connectStart = std::chrono::steady_clock::now();
+        std::unique_ptr<ClientPlayer> clientPlayer = connectPlayer(clientArguments, serverAddress);
+        connectMicros += microsSince(connectStart);
+
+        int gameStatus = ClientConstants::GAME_DISCONNECTED;
+        if (clientPlayer != nullptr) {
+            connections++;
+            gameStatus = clientPlayer->handleGame();
+            clientPlayer->closeConnection();
+        }
+
+        if (gameStatus == ClientConstants::GAME_FINISHED) {
+            uint64_t gameMicros = microsSince(gameStart);
+            gamesPlayed++;
+            minMicros = std::min(minMicros, gameMicros);
+            maxMicros = std::max(maxMicros, gameMicros);
+
+            std::cerr << "game " << gamesPlayed << ": " << gameMicros << " us, connecting "
+                      << connectMicros << " us, connections " << connections << std::endl;
+
+            backoff = ClientConstants::SESSION_BACKOFF_MIN;
+            failedAttempts = 0;
+            connections = 0;
+            connectMicros = 0;
+            gameStart = std::chrono::steady_clock::now();
+            continue;
+        }
+
+        if (++failedAttempts == ClientConstants::SESSION_MAX_ATTEMPTS) {
+            fatal("server unavailable after %d attempts", failedAttempts);
+        }
+
+        usleep(backoff * 1000);
+        backoff = std::min(2 * backoff, ClientConstants::SESSION_BACKOFF_MAX);
+    }
+
+    uint64_t sessionMicros = microsSince(sessionStart);
+    std::cerr << "session: " << gamesPlayed << " games in " << sessionMicros << " us, mean "
+              << (gamesPlayed > 0 ? sessionMicros / gamesPlayed : 0) << " us, min "
+              << (gamesPlayed > 0 ? minMicros : 0) << " us, max " << maxMicros << " us"
+              << std::endl;
+}
+
+int main(int argc, char **argv) {
+    ClientArguments clientArguments = ClientArguments();
+    parseUserInput(argc, argv, clientArguments);
+
+    sockaddr_storage serverAddress;
+    if (not isUnixHost(clientArguments.host)) {
+        resolveTcpServer(clientArguments, serverAddress);
+    }
+
+    if (clientArguments.session) {
+        // Connection closed by server is reconnected, it must not kill the client.
+        signal(SIGPIPE, SIG_IGN);
+
+        playSession(clientArguments, serverAddress);
+        return 0;
+    }
+
+    std::unique_ptr<ClientPlayer> clientPlayer = connectPlayer(clientArguments, serverAddress);
+    clientPlayer->handleGame();
+    clientPlayer->closeConnection();
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,319 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+#include "common/common.h"
+#include "common/rules.h"
+
+/// REFERENCE RULES ///
+
+// Scoring as it was written before penalty tables, card by card for every hand type.
+
+/// @brief Returns penalty of bandit (hand type 7).
+static int referenceBandit(const std::vector<Card> &takenCards, int trickNumber) {
+    int points = 1;
+
+    for (const auto card : takenCards) {
+        if (card.cardColor == CARD_COLOR::H) {
+            points += 1;
+        }
+        if (card.cardValue == static_cast<int>(CARD_VALUE::Q)) {
+            points += 5;
+        }
+        if (card.cardValue == static_cast<int>(CARD_VALUE::J) or
+            card.cardValue == static_cast<int>(CARD_VALUE::K)) {
+            points += 2;
+        }
+        if (card.cardValue == static_cast<int>(CARD_VALUE::K) and card.cardColor == CARD_COLOR::H) {
+            points += 18;
+        }
+    }
+
+    if (trickNumber == 7 or trickNumber == Constants::TRICK_NUMBER) {
+        points += 10;
+    }
+    return points;
+}
+
+/// @brief Returns penalty for taking given cards in trick with given number.
+static int referencePenalty(HAND_TYPE handType, const std::vector<Card> &takenCards,
+                            int trickNumber) {
+    int points = 0;
+
+    switch (handType) {
+    case HAND_TYPE::DEFAULT:
+        points += 1;
+        break;
+
+    case HAND_TYPE::HEART:
+        for (const auto card : takenCards) {
+            if (card.cardColor == CARD_COLOR::H)
+                points += 1;
+        }
+        break;
+
+    case HAND_TYPE::QUEEN:
+        for (const auto card : takenCards) {
+            if (card.cardValue == static_cast<int>(CARD_VALUE::Q))
+                points += 5;
+        }
+        break;
+
+    case HAND_TYPE::GUYS:
+        for (const auto card : takenCards) {
+            if (card.cardValue == static_cast<int>(CARD_VALUE::J) or
+                card.cardValue == static_cast<int>(CARD_VALUE::K))
+                points += 2;
+        }
+        break;
+
+    case HAND_TYPE::HEART_KING:
+        for (const auto card : takenCards) {
+            if (card.cardValue == static_cast<int>(CARD_VALUE::K) and
+                card.cardColor == CARD_COLOR::H)
+                points += 18;
+        }
+        break;
+
+    case HAND_TYPE::SEVEN_N_LAST:
+        if (trickNumber == 7 or trickNumber == Constants::TRICK_NUMBER)
+            points += 10;
+        break;
+
+    case HAND_TYPE::BANDIT:
+        points += referenceBandit(takenCards, trickNumber);
+        break;
+
+    default:
+        break;
+    }
+
+    return points;
+}
+
+// Legal moves and trick winner as they were written before card masks, card by card.
+
+/// @brief Returns True if card's color is valid for given hand and led card and False otherwise.
+static bool referenceIsValidColor(const std::vector<Card> &playerCards,
+                                  const std::vector<Card> &placedCards, Card card) {
+    if (placedCards.empty()) {
+        return true;
+    }
+
+    bool hasMatchingCard = false;
+    CARD_COLOR firstPlacedColor = placedCards.front().cardColor;
+
+    for (auto playerCard : playerCards) {
+        if (playerCard.cardColor != firstPlacedColor) {
+            continue;
+        }
+
+        hasMatchingCard = true;
+        break;
+    }
+
+    if (hasMatchingCard and card.cardColor != firstPlacedColor) {
+        return false;
+    }
+
+    return true;
+}
+
+/// @brief Returns mask of cards from hand that pass referenceIsValidColor.
+static uint64_t referenceLegalMoves(const std::vector<Card> &playerCards,
+                                    const std::vector<Card> &placedCards) {
+    uint64_t legalMask = 0;
+    for (const auto card : playerCards) {
+        if (referenceIsValidColor(playerCards, placedCards, card)) {
+            legalMask |= 1ULL << getCardId(card);
+        }
+    }
+    return legalMask;
+}
+
+/// @brief Returns offset of trick winner from the player who led.
+static int referenceTrickWinner(const std::vector<Card> &placedCards) {
+    int winner = 0;
+    Card highestCard = placedCards[0];
+
+    for (int i = 1; i < Constants::PLAYERS_NUMBER; i++) {
+        if (placedCards[i].cardColor == highestCard.cardColor and
+            placedCards[i].cardValue > highestCard.cardValue) {
+
+            winner = i;
+            highestCard = placedCards[i];
+        }
+    }
+    return winner;
+}
+
+/// CHECK ///
+
+/// @brief Compares getTrickPenalty with reference rules for every set of cards in a trick, every
+/// hand type and every trick number, returns number of mismatches.
+static uint64_t checkAllTricks(uint64_t &cases) {
+    const int deckSize = CardConstants::DECK_SIZE;
+    const HAND_TYPE handTypes[] = {HAND_TYPE::UNDEFINED, HAND_TYPE::DEFAULT,
+                                   HAND_TYPE::HEART,     HAND_TYPE::QUEEN,
+                                   HAND_TYPE::GUYS,      HAND_TYPE::HEART_KING,
+                                   HAND_TYPE::SEVEN_N_LAST, HAND_TYPE::BANDIT};
+
+    uint64_t mismatches = 0;
+    std::vector<Card> takenCards(Constants::PLAYERS_NUMBER);
+
+    for (int first = 0; first < deckSize; first++) {
+        for (int second = first + 1; second < deckSize; second++) {
+            for (int third = second + 1; third < deckSize; third++) {
+                for (int fourth = third + 1; fourth < deckSize; fourth++) {
+                    takenCards[0] = getCardFromId(first);
+                    takenCards[1] = getCardFromId(second);
+                    takenCards[2] = getCardFromId(third);
+                    takenCards[3] = getCardFromId(fourth);
+                    uint64_t takenMask = getCardsMask(takenCards);
+
+                    for (HAND_TYPE handType : handTypes) {
+                        for (int trick = 1; trick <= Constants::TRICK_NUMBER; trick++) {
+                            cases++;
+                            int expected = referencePenalty(handType, takenCards, trick);
+                            int got = getTrickPenalty(handType, takenMask, trick);
+                            if (expected == got) {
+                                continue;
+                            }
+
+                            if (mismatches++ < 10) {
+                                printf("mismatch: hand type %d, trick %d, cards %d %d %d %d: "
+                                       "expected %d, got %d\n",
+                                       static_cast<int>(handType), trick, first, second, third,
+                                       fourth, expected, got);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return mismatches;
+}
+
+/// @brief Returns cards in given mask.
+static std::vector<Card> getCardsFromMask(uint64_t mask) {
+    std::vector<Card> cards;
+    for (int cardId = 0; cardId < CardConstants::DECK_SIZE; cardId++) {
+        if ((mask >> cardId) & 1) {
+            cards.push_back(getCardFromId(cardId));
+        }
+    }
+    return cards;
+}
+
+/// @brief Compares getLegalMoves with reference rules for every led card (or none) and every
+/// subset of the led color, with each other color empty, holding its lowest card or full.
+/// getLegalMoves sees other colors only through the led color mask, so these stand for any
+/// other cards. Returns number of mismatches.
+static uint64_t checkAllLegalMoves(uint64_t &cases) {
+    const CARD_COLOR colors[] = {CARD_COLOR::C, CARD_COLOR::D, CARD_COLOR::H, CARD_COLOR::S};
+    const int otherChoices = 3;
+
+    uint64_t mismatches = 0;
+    std::vector<Card> placedCards;
+
+    for (int ledCardId = -1; ledCardId < CardConstants::DECK_SIZE; ledCardId++) {
+        placedCards.clear();
+        if (ledCardId != -1) {
+            placedCards.push_back(getCardFromId(ledCardId));
+        }
+        CARD_COLOR ledColor = ledCardId == -1 ? CARD_COLOR::C : getCardFromId(ledCardId).cardColor;
+
+        for (uint64_t ledSubset = 0; ledSubset <= 0x1fff; ledSubset++) {
+            for (int others = 0; others < otherChoices * otherChoices * otherChoices; others++) {
+                uint64_t handMask = ledSubset << (static_cast<int>(ledColor) * 13);
+
+                int choices = others;
+                for (CARD_COLOR color : colors) {
+                    if (color == ledColor) {
+                        continue;
+                    }
+                    if (choices % otherChoices == 1) {
+                        handMask |= cardBit(color, CardConstants::LOWEST_VALUE);
+                    } else if (choices % otherChoices == 2) {
+                        handMask |= colorMask(color);
+                    }
+                    choices /= otherChoices;
+                }
+
+                cases++;
+                uint64_t expected = referenceLegalMoves(getCardsFromMask(handMask), placedCards);
+                uint64_t got = getLegalMoves(handMask, ledCardId);
+                if (expected == got) {
+                    continue;
+                }
+
+                if (mismatches++ < 10) {
+                    printf("mismatch: legal moves, led card %d, hand %#lx: expected %#lx, "
+                           "got %#lx\n",
+                           ledCardId, handMask, expected, got);
+                }
+            }
+        }
+    }
+
+    return mismatches;
+}
+
+/// @brief Compares getTrickWinner with reference rules for every ordered trick of four different
+/// cards, returns number of mismatches.
+static uint64_t checkAllTrickWinners(uint64_t &cases) {
+    const int deckSize = CardConstants::DECK_SIZE;
+
+    uint64_t mismatches = 0;
+    std::vector<Card> placedCards(Constants::PLAYERS_NUMBER);
+
+    for (int first = 0; first < deckSize; first++) {
+        for (int second = 0; second < deckSize; second++) {
+            if (second == first) {
+                continue;
+            }
+            for (int third = 0; third < deckSize; third++) {
+                if (third == first or third == second) {
+                    continue;
+                }
+                for (int fourth = 0; fourth < deckSize; fourth++) {
+                    if (fourth == first or fourth == second or fourth == third) {
+                        continue;
+                    }
+
+                    placedCards[0] = getCardFromId(first);
+                    placedCards[1] = getCardFromId(second);
+                    placedCards[2] = getCardFromId(third);
+                    placedCards[3] = getCardFromId(fourth);
+
+                    cases++;
+                    int expected = referenceTrickWinner(placedCards);
+                    int got = getTrickWinner(packTrick(placedCards));
+                    if (expected == got) {
+                        continue;
+                    }
+
+                    if (mismatches++ < 10) {
+                        printf("mismatch: trick winner, cards %d %d %d %d: expected %d, "
+                               "got %d\n",
+                               first, second, third, fourth, expected, got);
+                    }
+                }
+            }
+        }
+    }
+
+    return mismatches;
+}
+
+int main() {
+    uint64_t cases = 0;
+    uint64_t mismatches = checkAllTricks(cases);
+    mismatches += checkAllLegalMoves(cases);
+    mismatches += checkAllTrickWinners(cases);
+
+    printf("%lu cases, %lu mismatches\n", cases, mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -8,6 +8,7 @@
 #include <cstdlib>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <signal.h>
 #include <string.h>
 #include <sys/poll.h>
 #include <sys/socket.h>
@@ -19,27 +20,106 @@
 #include "server/serwer-parser.h"
 #include "err/err.h"
 
-/// @brief Function setups server.
-int setupServer(ServerArguments &serverArguments) {
-    // Create a socket.
-    int socketFd = socket(AF_INET6, SOCK_STREAM, 0);
+/// @brief Creates non blocking socket of given family bound to given address. Returns
+/// ERROR_CODE with errno set if socket cannot be created or bound.
+static int bindSocket(int family, const sockaddr *address, socklen_t addressLen) {
+    int socketFd = socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
     if (socketFd < 0) {
-        sysFatal("cannot create a socket");
+        return Constants::ERROR_CODE;
+    }
+
+    // Server restarted after a crash must be able to bind its port again at once.
+    int reuseAddress = 1;
+    if (setsockopt(socketFd, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress)) < 0) {
+        sysFatal("setsockopt");
+    }
+
+    if (bind(socketFd, address, addressLen) < 0) {
+        int bindErrno = errno;
+        close(socketFd);
+        errno = bindErrno;
+        return Constants::ERROR_CODE;
+    }
+
+    return socketFd;
+}
+
+/// @brief Switches bound socket to listening.
+static int listenOn(int socketFd, int queueLength) {
+    if (listen(socketFd, queueLength) < 0) {
+        sysFatal("listen");
     }
 
-    // Bind the socket to a concrete address.
+    return socketFd;
+}
+
+/// @brief Function setups non blocking listening socket on given port.
+int setupServer(uint16_t port, int queueLength) {
     sockaddr_in6 serverAddress;
     memset(&serverAddress, 0, sizeof(serverAddress));
     serverAddress.sin6_family = AF_INET6;  // IPv6
     serverAddress.sin6_addr = in6addr_any; // Listening on all interfaces.
-    serverAddress.sin6_port = htons(serverArguments.port);
+    serverAddress.sin6_port = htons(port);
 
-    if (bind(socketFd, (sockaddr *)&serverAddress, sizeof(serverAddress)) < 0) {
+    int socketFd = bindSocket(AF_INET6, (sockaddr *)&serverAddress, sizeof(serverAddress));
+    if (socketFd < 0) {
         sysFatal("bind");
     }
 
-    // Switch the socket to listening.
-    if (listen(socketFd, ServerConstants::QUEUE_LENGTH) < 0) {
+    return listenOn(socketFd, queueLength);
+}
+
+/// @brief Function setups non blocking listening socket on given port of loopback interface
+/// only, ::1 or 127.0.0.1 if host has no IPv6.
+int setupLocalServer(uint16_t port, int queueLength) {
+    sockaddr_in6 serverAddress;
+    memset(&serverAddress, 0, sizeof(serverAddress));
+    serverAddress.sin6_family = AF_INET6;
+    serverAddress.sin6_addr = in6addr_loopback;
+    serverAddress.sin6_port = htons(port);
+
+    int socketFd = bindSocket(AF_INET6, (sockaddr *)&serverAddress, sizeof(serverAddress));
+    if (socketFd < 0 and (errno == EAFNOSUPPORT or errno == EADDRNOTAVAIL)) {
+        sockaddr_in serverAddressV4;
+        memset(&serverAddressV4, 0, sizeof(serverAddressV4));
+        serverAddressV4.sin_family = AF_INET;
+        serverAddressV4.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        serverAddressV4.sin_port = htons(port);
+
+        socketFd = bindSocket(AF_INET, (sockaddr *)&serverAddressV4, sizeof(serverAddressV4));
+    }
+
+    if (socketFd < 0) {
+        sysFatal("bind");
+    }
+
+    return listenOn(socketFd, queueLength);
+}
+
+/// @brief Function setups non blocking listening unix socket at given path, or in abstract
+/// namespace if path starts with @.
+int setupUnixServer(const char *path, int queueLength) {
+    sockaddr_un serverAddress;
+    socklen_t serverAddressLen;
+    if (not setUnixAddress(serverAddress, serverAddressLen, path)) {
+        fatal("%s is not a valid unix socket path", path);
+    }
+
+    int socketFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (socketFd < 0) {
+        sysFatal("cannot create a socket");
+    }
+
+    // Socket file left by previous server must not stop us from binding.
+    if (path[0] != SocketConstants::ABSTRACT_PREFIX) {
+        unlink(path);
+    }
+
+    if (bind(socketFd, (sockaddr *)&serverAddress, serverAddressLen) < 0) {
+        sysFatal("bind %s", path);
+    }
+
+    if (listen(socketFd, queueLength) < 0) {
         sysFatal("listen");
     }
 
@@ -48,12 +128,37 @@ int setupServer(ServerArguments &serverArguments) {
 
 int main(int argc, char **argv) {
     ServerArguments serverArguments = ServerArguments();
-    ServerStatus serverStatus;
-    parseUserInput(argc, argv, serverArguments, serverStatus);
+    std::vector<ServerStatus> games;
+    parseUserInput(argc, argv, serverArguments, games);
+
+    // Peers closing connections must not kill the server.
+    signal(SIGPIPE, SIG_IGN);
 
-    int socketFd = setupServer(serverArguments);
+    // If server is already running at upgrade socket, we take its sockets and game over.
+    int upgradeFd = Constants::ERROR_CODE;
+    if (serverArguments.upgradeStr != nullptr) {
+        upgradeFd = connectToRunningServer(serverArguments.upgradeStr);
+    }
+
+    int socketFd = Constants::ERROR_CODE;
+    int unixSocketFd = Constants::ERROR_CODE;
+    int metricsFd = Constants::ERROR_CODE;
+    if (upgradeFd < 0) {
+        socketFd = setupServer(serverArguments.port, serverArguments.queueLength);
+
+        if (serverArguments.unixPathStr != nullptr) {
+            unixSocketFd =
+                setupUnixServer(serverArguments.unixPathStr, serverArguments.queueLength);
+        }
+
+        if (serverArguments.metricsPortStr != nullptr) {
+            metricsFd =
+                setupLocalServer(serverArguments.metricsPort, ServerConstants::QUEUE_LENGTH);
+        }
+    }
 
-    ServerCroupier serverCroupier = ServerCroupier(socketFd, serverArguments, serverStatus);
+    ServerCroupier serverCroupier = ServerCroupier(socketFd, unixSocketFd, metricsFd, upgradeFd,
+                                                   serverArguments, games);
     serverCroupier.handleGame();
 
     close(socketFd);
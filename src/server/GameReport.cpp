@@ -0,0 +1,240 @@
+#include "server/GameReport.h"
+
+#include <algorithm>
+
+#include "err/err.h"
+
+/// @brief Writes time point of steady clock, which is shared by processes on the same machine.
+static void writeTimePoint(StateWriter &stateWriter, std::chrono::steady_clock::time_point at) {
+    stateWriter.writeInt(at.time_since_epoch().count());
+}
+
+/// @brief Reads time point written by writeTimePoint.
+static std::chrono::steady_clock::time_point readTimePoint(StateReader &stateReader) {
+    return std::chrono::steady_clock::time_point(
+        std::chrono::steady_clock::duration(stateReader.readInt()));
+}
+
+/// @brief Writes timing of a single trick.
+static void writeTrickTiming(StateWriter &stateWriter, const TrickTiming &timing) {
+    stateWriter.writeInt(timing.hand);
+    stateWriter.writeInt(timing.trick);
+    stateWriter.writeInt(timing.startMicros);
+    stateWriter.writeInt(timing.durationMicros);
+    stateWriter.writeInt(timing.stallMicros);
+
+    for (int seat = 0; seat < Constants::PLAYERS_NUMBER; seat++) {
+        stateWriter.writeInt(timing.thinkMicros[seat]);
+        stateWriter.writeInt(timing.wrong[seat]);
+        stateWriter.writeInt(timing.timeouts[seat]);
+        stateWriter.writeInt(timing.reconnects[seat]);
+        stateWriter.writeInt(timing.botCard[seat]);
+    }
+}
+
+/// @brief Reads timing written by writeTrickTiming.
+static TrickTiming readTrickTiming(StateReader &stateReader) {
+    TrickTiming timing;
+    timing.hand = (int)stateReader.readInt();
+    timing.trick = (int)stateReader.readInt();
+    timing.startMicros = stateReader.readInt();
+    timing.durationMicros = stateReader.readInt();
+    timing.stallMicros = stateReader.readInt();
+
+    for (int seat = 0; seat < Constants::PLAYERS_NUMBER; seat++) {
+        timing.thinkMicros[seat] = stateReader.readInt();
+        timing.wrong[seat] = (int)stateReader.readInt();
+        timing.timeouts[seat] = (int)stateReader.readInt();
+        timing.reconnects[seat] = (int)stateReader.readInt();
+        timing.botCard[seat] = stateReader.readInt() != 0;
+    }
+    return timing;
+}
+
+uint64_t TrickTiming::getThinkMicros() const {
+    uint64_t think = 0;
+    for (uint64_t seatThink : thinkMicros) {
+        think += seatThink;
+    }
+    return think;
+}
+
+uint64_t TrickTiming::getProcessingMicros() const {
+    uint64_t waited = getThinkMicros() + stallMicros;
+    return durationMicros > waited ? durationMicros - waited : 0;
+}
+
+void GameReport::writeReport() {
+    uint64_t think = 0;
+    uint64_t processing = 0;
+    uint64_t stall = 0;
+    uint64_t seatThink[Constants::PLAYERS_NUMBER] = {};
+    uint64_t seatMaxThink[Constants::PLAYERS_NUMBER] = {};
+    int seatWrong[Constants::PLAYERS_NUMBER] = {};
+    int seatTimeouts[Constants::PLAYERS_NUMBER] = {};
+    int seatReconnects[Constants::PLAYERS_NUMBER] = {};
+    int seatBotCards[Constants::PLAYERS_NUMBER] = {};
+
+    for (const TrickTiming &timing : tricks) {
+        think += timing.getThinkMicros();
+        processing += timing.getProcessingMicros();
+        stall += timing.stallMicros;
+
+        for (int seat = 0; seat < Constants::PLAYERS_NUMBER; seat++) {
+            seatThink[seat] += timing.thinkMicros[seat];
+            seatMaxThink[seat] = std::max(seatMaxThink[seat], timing.thinkMicros[seat]);
+            seatWrong[seat] += timing.wrong[seat];
+            seatTimeouts[seat] += timing.timeouts[seat];
+            seatReconnects[seat] += timing.reconnects[seat];
+            seatBotCards[seat] += timing.botCard[seat];
+        }
+    }
+
+    int hands = tricks.empty() ? 0 : tricks.back().hand - tricks.front().hand + 1;
+    reportFile << "game=" << gamesReported << " hands=" << hands << " tricks=" << tricks.size()
+               << " duration_us=" << microsSince(gameStartedAt) << " think_us=" << think
+               << " processing_us=" << processing << " stall_us=" << stall << "\n";
+
+    for (int seat = 0; seat < Constants::PLAYERS_NUMBER; seat++) {
+        reportFile << "seat=" << tablePlaceToChar(seat) << " think_us=" << seatThink[seat]
+                   << " max_think_us=" << seatMaxThink[seat]
+                   << " cards=" << (int)tricks.size() - seatBotCards[seat]
+                   << " bot_cards=" << seatBotCards[seat] << " wrong=" << seatWrong[seat]
+                   << " timeouts=" << seatTimeouts[seat]
+                   << " reconnects=" << seatReconnects[seat] << "\n";
+    }
+
+    for (const TrickTiming &timing : tricks) {
+        reportFile << "trick=" << timing.hand << "." << timing.trick
+                   << " start_us=" << timing.startMicros
+                   << " duration_us=" << timing.durationMicros << " think_us=";
+
+        int wrong = 0;
+        int timeouts = 0;
+        int reconnects = 0;
+        for (int seat = 0; seat < Constants::PLAYERS_NUMBER; seat++) {
+            reportFile << (seat == 0 ? "" : ",") << tablePlaceToChar(seat) << ":";
+            if (timing.botCard[seat]) {
+                reportFile << "bot";
+            } else {
+                reportFile << timing.thinkMicros[seat];
+            }
+
+            wrong += timing.wrong[seat];
+            timeouts += timing.timeouts[seat];
+            reconnects += timing.reconnects[seat];
+        }
+
+        reportFile << " processing_us=" << timing.getProcessingMicros()
+                   << " stall_us=" << timing.stallMicros << " wrong=" << wrong
+                   << " timeouts=" << timeouts << " reconnects=" << reconnects << "\n";
+    }
+
+    reportFile << std::endl;
+    if (not reportFile) {
+        error("cannot write report %s", path.c_str());
+        reportFile.clear();
+    }
+}
+
+void GameReport::openReport(const char *reportPath) {
+    if (reportPath == nullptr) {
+        return;
+    }
+
+    enabled = true;
+    path = reportPath;
+    reportFile.open(path, std::ios::app);
+    if (not reportFile) {
+        sysFatal("cannot open report %s", reportPath);
+    }
+}
+
+void GameReport::startGame() {
+    started = true;
+    gameStartedAt = std::chrono::steady_clock::now();
+    trickStartedAt = gameStartedAt;
+    current = TrickTiming();
+    tricks.clear();
+}
+
+void GameReport::addThink(int seat, uint64_t micros) {
+    current.thinkMicros[seat] += micros;
+}
+
+void GameReport::addStall(uint64_t micros) {
+    current.stallMicros += micros;
+}
+
+void GameReport::addWrong(int seat) {
+    current.wrong[seat]++;
+}
+
+void GameReport::addTimeout(int seat) {
+    current.timeouts[seat]++;
+}
+
+void GameReport::addReconnect(int seat) {
+    current.reconnects[seat]++;
+}
+
+void GameReport::addBotCard(int seat) {
+    current.botCard[seat] = true;
+}
+
+void GameReport::finishTrick(int hand, int trick) {
+    if (not enabled or not started) {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+
+    current.hand = hand;
+    current.trick = trick;
+    current.startMicros =
+        std::chrono::duration_cast<std::chrono::microseconds>(trickStartedAt - gameStartedAt)
+            .count();
+    current.durationMicros =
+        std::chrono::duration_cast<std::chrono::microseconds>(now - trickStartedAt).count();
+    tricks.emplace_back(current);
+
+    current = TrickTiming();
+    trickStartedAt = now;
+}
+
+void GameReport::finishGame() {
+    if (enabled and started) {
+        gamesReported++;
+        writeReport();
+    }
+
+    started = false;
+    tricks.clear();
+}
+
+void GameReport::serialize(StateWriter &stateWriter) {
+    stateWriter.writeInt(gamesReported);
+    stateWriter.writeInt(started);
+    writeTimePoint(stateWriter, gameStartedAt);
+    writeTimePoint(stateWriter, trickStartedAt);
+
+    writeTrickTiming(stateWriter, current);
+    stateWriter.writeInt(tricks.size());
+    for (const TrickTiming &timing : tricks) {
+        writeTrickTiming(stateWriter, timing);
+    }
+}
+
+void GameReport::deserialize(StateReader &stateReader) {
+    gamesReported = (int)stateReader.readInt();
+    started = stateReader.readInt() != 0;
+    gameStartedAt = readTimePoint(stateReader);
+    trickStartedAt = readTimePoint(stateReader);
+
+    current = readTrickTiming(stateReader);
+    tricks.clear();
+    int64_t size = stateReader.readInt();
+    for (int64_t i = 0; i < size and not stateReader.hasFailed(); i++) {
+        tricks.emplace_back(readTrickTiming(stateReader));
+    }
+}
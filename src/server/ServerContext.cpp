@@ -1,28 +1,93 @@
 #include "server/ServerContext.h"
+#include "server/ServerMetrics.h"
 
-void ServerContext::createContext(int _baseTimeout, int _socketFd) {
+void ServerContext::createContext(int _baseTimeout, int _socketFd, int _unixSocketFd,
+                                  int _metricsFd) {
     this->baseTimeout = _baseTimeout;
-    this->socketTimeouts.assign(ServerConstants::CONNECTIONS, baseTimeout);
-    this->waitingFor.assign(ServerConstants::CONNECTIONS, false);
-    this->readBuffers.resize(ServerConstants::CONNECTIONS, ReadBuffer());
-    this->writeBuffers.resize(ServerConstants::CONNECTIONS, WriteBuffer());
-    this->clientAddressStr.resize(ServerConstants::CONNECTIONS);
-    this->serverAddressStr.resize(ServerConstants::CONNECTIONS);
     this->socketFd = _socketFd;
-    this->clientStates.resize(ServerConstants::CONNECTIONS, CLIENT_STATE::WAITING_FOR_START);
+    this->unixSocketFd = _unixSocketFd;
 
     storedPollEvents.resize(Constants::PLAYERS_NUMBER);
 
     initializePollStructures();
+
+    pollDescriptors[ServerConstants::METRICS_INDEX].fd = _metricsFd;
+}
+
+void ServerContext::setConnectionLimits(size_t _readLimit, size_t _writeLimit) {
+    this->readLimit = _readLimit;
+    this->writeLimit = _writeLimit;
+}
+
+void ServerContext::setSocketOptions(const SocketOptions &_socketOptions) {
+    this->socketOptions = _socketOptions;
+}
+
+bool ServerContext::corksWrites() {
+    return socketOptions.cork;
+}
+
+void ServerContext::addSlab() {
+    int slabStart = getSlotsNumber();
+
+    slabs.emplace_back(std::make_unique<Connection[]>(ServerConstants::SLAB_SIZE));
+    pollDescriptors.resize(slabStart + ServerConstants::SLAB_SIZE);
+
+    for (int index = slabStart; index < getSlotsNumber(); index++) {
+        resetPollDescriptor(index);
+        connectionAt(index).socketTimeout = baseTimeout;
+    }
+
+    // Slots are handed out from the back, so lower ones are used first.
+    for (int index = getSlotsNumber() - 1;
+         index >= std::max(slabStart, ServerConstants::FIRST_CONNECTION); index--) {
+        freeSlots.emplace_back(index);
+    }
+
+    metricsAddGauge(METRIC_GAUGE::CONNECTION_TABLE_BYTES,
+                    ServerConstants::SLAB_SIZE * ConnectionConstants::SLOT_BYTES);
+}
+
+void ServerContext::rebuildFreeSlots() {
+    freeSlots.clear();
+    for (int index = getSlotsNumber() - 1; index >= ServerConstants::FIRST_CONNECTION; index--) {
+        if (not isDescriptorReserved(index)) {
+            freeSlots.emplace_back(index);
+        }
+    }
 }
 
 void ServerContext::initializePollStructures() {
-    for (int index = 0; index < ServerConstants::CONNECTIONS; index++) {
+    if (slabs.empty()) {
+        addSlab();
+    }
+
+    for (int index = 0; index < getSlotsNumber(); index++) {
         resetPollDescriptor(index);
     }
+    rebuildFreeSlots();
 
     pollDescriptors[ServerConstants::ACCEPT_INDEX].fd = socketFd;
-    socketTimeouts[ServerConstants::ACCEPT_INDEX] = -1;
+    connectionAt(ServerConstants::ACCEPT_INDEX).socketTimeout = -1;
+    pollDescriptors[ServerConstants::UNIX_ACCEPT_INDEX].fd = unixSocketFd;
+    connectionAt(ServerConstants::UNIX_ACCEPT_INDEX).socketTimeout = -1;
+}
+
+int ServerContext::reserveSlot() {
+    if (freeSlots.empty()) {
+        if (getSlotsNumber() >= ServerConstants::MAX_CONNECTIONS) {
+            return Constants::ERROR_CODE;
+        }
+        addSlab();
+    }
+
+    int index = freeSlots.back();
+    freeSlots.pop_back();
+    return index;
+}
+
+int ServerContext::getSlotsNumber() {
+    return (int)pollDescriptors.size();
 }
 
 void ServerContext::resetPollDescriptor(const int index) {
@@ -57,16 +122,27 @@ void ServerContext::pollSetWrite(int index) {
     pollDescriptors[index].events |= POLLOUT;
 }
 
+void ServerContext::setPollDescriptor(int index, int fd, short events) {
+    pollDescriptors[index].fd = fd;
+    pollDescriptors[index].events = events;
+    pollDescriptors[index].revents = 0;
+}
+
+void ServerContext::setPollEvents(int index, short events) {
+    pollDescriptors[index].events = events;
+}
+
 int ServerContext::getPollTimeout(int startingPoint) {
     int pollTimeout = -1;
-    for (int i = startingPoint; i < ServerConstants::CONNECTIONS; i++) {
-        if (not waitingFor[i] or pollDescriptors[i].events == 0)
+    for (int i : waitingIndexes) {
+        if (i < startingPoint or pollDescriptors[i].events == 0)
             continue;
 
+        Connection &connection = connectionAt(i);
         if (pollTimeout == -1) {
-            pollTimeout = socketTimeouts[i];
+            pollTimeout = connection.socketTimeout;
         } else {
-            pollTimeout = std::min(pollTimeout, socketTimeouts[i]);
+            pollTimeout = std::min(pollTimeout, connection.socketTimeout);
         }
     }
 
@@ -74,38 +150,148 @@ int ServerContext::getPollTimeout(int startingPoint) {
 }
 
 void ServerContext::resetRevents(int startingPoint) {
-    for (int i = startingPoint; i < ServerConstants::CONNECTIONS; i++) {
-        if (pollDescriptors[i].events != 0) {
+    auto resetAt = [&](int i) {
+        if (i >= startingPoint and pollDescriptors[i].events != 0) {
             pollDescriptors[i].revents = 0;
         }
+    };
+
+    for (int i = startingPoint; i < ServerConstants::FIRST_CONNECTION; i++) {
+        resetAt(i);
+    }
+    for (int i : readyToRead) {
+        resetAt(i);
+    }
+    for (int i : readyToWrite) {
+        resetAt(i);
     }
 }
 
 void ServerContext::revaluateTimeouts(int duration, int startingPoint) {
-    for (int i = startingPoint; i < (int)socketTimeouts.size(); i++) {
-        if (i == ServerConstants::ACCEPT_INDEX or not waitingFor[i] or
-            pollDescriptors[i].events == 0) {
+    for (int i : waitingIndexes) {
+        if (i < startingPoint or i == ServerConstants::ACCEPT_INDEX or
+            i == ServerConstants::UNIX_ACCEPT_INDEX or pollDescriptors[i].events == 0) {
             continue;
         }
 
-        socketTimeouts[i] = std::max(socketTimeouts[i] - duration, 0);
+        Connection &connection = connectionAt(i);
+        connection.socketTimeout = std::max(connection.socketTimeout - duration, 0);
+    }
+}
+
+void ServerContext::collectReady(int startingPoint, int readyCount) {
+    readyToRead.clear();
+    readyToWrite.clear();
+
+    for (int i = startingPoint; i < getSlotsNumber() and readyCount > 0; i++) {
+        short revents = pollDescriptors[i].revents;
+        if (revents == 0) {
+            continue;
+        }
+        readyCount--;
+
+        // Metrics and upgrade descriptors are served by their owners.
+        if (i >= ServerConstants::METRICS_INDEX and i < ServerConstants::FIRST_CONNECTION) {
+            continue;
+        }
+
+        if (revents & (POLLIN | POLLERR)) {
+            readyToRead.emplace_back(i);
+        }
+        if (revents & POLLOUT) {
+            readyToWrite.emplace_back(i);
+        }
     }
 }
 
-int ServerContext::executePoll(bool includePlayers) {
+int ServerContext::prepareShmForPoll(int startingPoint, int timeout) {
+    auto polled = [&](int index) {
+        return index >= startingPoint and (pollDescriptors[index].events & POLLIN);
+    };
+
+    // TCP clients wait at most the spin for us, bots get their frames without a wakeup.
+    if (timeout != 0 and canSpin()) {
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::microseconds(ShmConstants::SERVER_SPIN_MICROS);
+        do {
+            for (auto &[index, channel] : shmChannels) {
+                if (polled(index) and channel.hasInput()) {
+                    timeout = 0;
+                }
+            }
+        } while (timeout != 0 and std::chrono::steady_clock::now() < deadline);
+    }
+
+    for (auto &[index, channel] : shmChannels) {
+        // Channel with full ring is written again only once client made room and rang.
+        if (channel.isBlocked()) {
+            pollDescriptors[index].events &= ~POLLOUT;
+        }
+        if (polled(index) and not channel.setIdle()) {
+            timeout = 0;
+        }
+    }
+
+    return timeout;
+}
+
+int ServerContext::collectShmReady(int startingPoint) {
+    int becameReady = 0;
+    for (auto &[index, channel] : shmChannels) {
+        pollfd &descriptor = pollDescriptors[index];
+        channel.setBusy(descriptor.revents & (POLLIN | POLLERR | POLLHUP));
+        if (index < startingPoint) {
+            continue;
+        }
+
+        short revents = descriptor.revents;
+        if ((descriptor.events & POLLIN) and channel.hasInput()) {
+            descriptor.revents |= POLLIN;
+        }
+        if (channel.takeUnblocked() and
+            (hasPendingWriteAt(index) or
+             connectionAt(index).clientState == CLIENT_STATE::SPECTATING)) {
+            descriptor.events |= POLLOUT;
+            descriptor.revents |= POLLOUT;
+        }
+
+        if (revents == 0 and descriptor.revents != 0) {
+            becameReady++;
+        }
+    }
+
+    return becameReady;
+}
+
+int ServerContext::executePoll(bool includePlayers, int timeoutLimit) {
     int startingPoint = includePlayers ? 0 : ServerConstants::ACCEPT_INDEX;
     int timeout = getPollTimeout(startingPoint);
+    if (timeoutLimit >= 0 and (timeout < 0 or timeoutLimit < timeout)) {
+        timeout = timeoutLimit;
+    }
 
     resetRevents(startingPoint);
 
     auto start = std::chrono::high_resolution_clock::now();
 
-    int pollStatus = poll(pollDescriptors + startingPoint,
-                          ServerConstants::CONNECTIONS - startingPoint, timeout);
+    if (not shmChannels.empty()) {
+        timeout = prepareShmForPoll(startingPoint, timeout);
+    }
+
+    int pollStatus =
+        poll(pollDescriptors.data() + startingPoint, getSlotsNumber() - startingPoint, timeout);
     if (pollStatus == -1) {
+        readyToRead.clear();
+        readyToWrite.clear();
         return -1;
     }
 
+    if (not shmChannels.empty()) {
+        pollStatus += collectShmReady(startingPoint);
+    }
+
+    collectReady(startingPoint, pollStatus);
+
     auto end = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
 
@@ -114,110 +300,282 @@ int ServerContext::executePoll(bool includePlayers) {
     return pollStatus;
 }
 
+const std::vector<int> &ServerContext::getReadyToRead() {
+    return readyToRead;
+}
+
+const std::vector<int> &ServerContext::getReadyToWrite() {
+    return readyToWrite;
+}
+
 void ServerContext::startWaitingFor(const int index) {
-    waitingFor[index] = true;
+    if (isWaitingFor(index)) {
+        return;
+    }
+
+    connectionAt(index).waitingPosition = (int)waitingIndexes.size();
+    waitingIndexes.emplace_back(index);
 }
 
 void ServerContext::stopWaitingFor(const int index) {
-    waitingFor[index] = false;
+    if (not isWaitingFor(index)) {
+        return;
+    }
+
+    // Last connection takes place of the removed one.
+    int position = connectionAt(index).waitingPosition;
+    int last = waitingIndexes.back();
+    waitingIndexes[position] = last;
+    connectionAt(last).waitingPosition = position;
+
+    waitingIndexes.pop_back();
+    connectionAt(index).waitingPosition = Constants::ERROR_CODE;
 }
 
 bool ServerContext::timeoutAt(int index) {
-    return waitingFor[index] and socketTimeouts[index] == 0;
+    return isWaitingFor(index) and connectionAt(index).socketTimeout == 0;
 }
 
 void ServerContext::resetTimeout(int index) {
-    socketTimeouts[index] = baseTimeout;
+    connectionAt(index).socketTimeout = baseTimeout;
 }
 
-void ServerContext::acceptConnection(int index, int clientFd, bool gameFull,
-                                     const std::string &clientIP, const std::string &serverIp) {
+void ServerContext::collectTimedOut(int firstIndex, std::vector<int> &indexes) {
+    for (int i : waitingIndexes) {
+        if (i >= firstIndex and connectionAt(i).socketTimeout == 0) {
+            indexes.emplace_back(i);
+        }
+    }
+}
+
+void ServerContext::acceptConnection(int index, int clientFd, const sockaddr_in6 &clientAddress) {
     pollDescriptors[index].fd = clientFd;
     pollDescriptors[index].events = POLLIN;
-    clientAddressStr[index] = clientIP;
-    serverAddressStr[index] = serverIp;
-
-    if (gameFull) {
-        initiateSending(index, ServerConstants::GAME_FULL_MESSAGE, CLIENT_STATE::SENDING_BUSY);
-        return;
+    connectionAt(index).clientAddress = clientAddress;
+    if (clientAddress.sin6_family != AF_UNIX) {
+        applySocketOptions(clientFd, socketOptions);
     }
 
-    clientStates[index] = CLIENT_STATE::WAITING_FOR_IAM;
+    connectionAt(index).clientState = CLIENT_STATE::WAITING_FOR_IAM;
     startWaitingFor(index);
 }
 
 void ServerContext::movePlayer(const int from, const int to) {
     pollDescriptors[to].fd = pollDescriptors[from].fd;
 
-    clientAddressStr[to] = clientAddressStr[from];
-    serverAddressStr[to] = serverAddressStr[from];
+    Connection &source = connectionAt(from);
+    Connection &target = connectionAt(to);
+    target.clientAddress = source.clientAddress;
+    target.clientAddressStr = std::move(source.clientAddressStr);
+    target.serverAddressStr = std::move(source.serverAddressStr);
 
-    readBuffers[to] = readBuffers[from];
-    writeBuffers[to] = writeBuffers[from];
+    target.readBuffer = std::move(source.readBuffer);
+    target.writeBuffer = std::move(source.writeBuffer);
 
-    clientStates[to] = CLIENT_STATE::SENDING_DEAL;
+    target.clientState = CLIENT_STATE::SENDING_DEAL;
+
+    auto channel = shmChannels.find(from);
+    if (channel != shmChannels.end()) {
+        shmChannels[to] = channel->second;
+        shmChannels.erase(channel);
+    }
 
     closeConnection(from, false);
 }
 
 void ServerContext::closeConnection(int index, bool closeFd) {
+    bool wasReserved = isDescriptorReserved(index);
     if (closeFd) {
         close(pollDescriptors[index].fd);
     }
     resetPollDescriptor(index);
 
+    auto channel = shmChannels.find(index);
+    if (channel != shmChannels.end()) {
+        channel->second.release();
+        shmChannels.erase(channel);
+    }
+
     stopWaitingFor(index);
     resetTimeout(index);
 
-    readBuffers[index] = ReadBuffer();
-    writeBuffers[index] = WriteBuffer();
+    // Swapping with empty values releases memory, so closed slot is idle again.
+    Connection &connection = connectionAt(index);
+    connection.readBuffer.reset();
+    connection.writeBuffer = WriteBuffer();
+    connection.overWriteLimit = false;
+
+    std::string().swap(connection.clientAddressStr);
+    std::string().swap(connection.serverAddressStr);
+    connection.clientState = CLIENT_STATE::EMPTY_PLACE;
+
+    if (wasReserved and index >= ServerConstants::FIRST_CONNECTION) {
+        freeSlots.emplace_back(index);
+    }
+}
 
-    clientAddressStr[index].clear();
-    serverAddressStr[index].clear();
-    clientStates[index] = CLIENT_STATE::EMPTY_PLACE;
+const std::string &ServerContext::getClientAddressStrAt(int index) {
+    Connection &connection = connectionAt(index);
+    if (connection.clientAddressStr.empty()) {
+        connection.clientAddressStr =
+            getClientAddressStr(pollDescriptors[index].fd, connection.clientAddress);
+    }
+    return connection.clientAddressStr;
+}
+
+const std::string &ServerContext::getServerAddressStrAt(int index) {
+    Connection &connection = connectionAt(index);
+    if (connection.serverAddressStr.empty()) {
+        connection.serverAddressStr =
+            getLocalAddressStr(pollDescriptors[index].fd, connection.clientAddress);
+    }
+    return connection.serverAddressStr;
 }
 
 void ServerContext::displayMessageFromClient(const int index, const std::string &message) {
-    display(clientAddressStr[index], serverAddressStr[index], message);
+    display(getClientAddressStrAt(index), getServerAddressStrAt(index), message);
 }
 
 void ServerContext::displayMessageFromServer(const int index, const std::string &message) {
-    display(serverAddressStr[index], clientAddressStr[index], message);
+    // Single write may carry several messages (deal with catch-up), we display each separately.
+    size_t start = 0, end;
+    while ((end = message.find(Messages::END_OF_MESSAGE, start)) != std::string::npos) {
+        end += Messages::END_OF_MESSAGE.size();
+        display(getServerAddressStrAt(index), getClientAddressStrAt(index),
+                message.substr(start, end - start));
+        start = end;
+    }
+
+    if (start < message.size()) {
+        display(getServerAddressStrAt(index), getClientAddressStrAt(index),
+                message.substr(start));
+    }
 }
 
-ssize_t ServerContext::sendMessageServer(int index, std::string &message) {
-    return sendMessage(pollDescriptors[index].fd, message.c_str(), message.size());
+ssize_t ServerContext::sendMessageServer(int index, std::string &message, bool inBurst) {
+    WriteBuffer &writeBuffer = connectionAt(index).writeBuffer;
+    if (not inBurst or not socketOptions.cork or writeBuffer.messages.size() < 2 or
+        shmChannels.contains(index)) {
+        return sendBytesServer(index, message.c_str(), message.size());
+    }
+
+    ssize_t sentLen = sendMessageMore(pollDescriptors[index].fd, message.c_str(), message.size());
+    if (sentLen > 0) {
+        metricsIncrement(METRIC_COUNTER::BYTES_OUT, sentLen);
+    }
+    return sentLen;
+}
+
+ssize_t ServerContext::sendBytesServer(int index, const char *data, size_t len) {
+    ssize_t sentLen;
+    auto channel = shmChannels.find(index);
+    if (channel != shmChannels.end()) {
+        sentLen = channel->second.send(data, len);
+    } else {
+        sentLen = sendMessage(pollDescriptors[index].fd, data, len);
+    }
+
+    if (sentLen > 0) {
+        metricsIncrement(METRIC_COUNTER::BYTES_OUT, sentLen);
+    }
+    return sentLen;
+}
+
+ssize_t ServerContext::receiveAt(int index, char *buffer, size_t len) {
+    auto channel = shmChannels.find(index);
+    if (channel != shmChannels.end()) {
+        return channel->second.receive(buffer, len);
+    }
+
+    return read(pollDescriptors[index].fd, buffer, len);
+}
+
+bool ServerContext::upgradeToShm(int index, const std::string &reply) {
+    if (connectionAt(index).clientAddress.sin6_family != AF_UNIX or shmChannels.contains(index)) {
+        return false;
+    }
+
+    ShmChannel channel;
+    if (not channel.create(pollDescriptors[index].fd)) {
+        return false;
+    }
+
+    if (not sendMemFd(pollDescriptors[index].fd, reply, channel.getMemFd())) {
+        channel.release();
+        return false;
+    }
+
+    shmChannels[index] = channel;
+    metricsIncrement(METRIC_COUNTER::SHM_CONNECTIONS);
+    return true;
+}
+
+void ServerContext::rearmQuickAckAt(int index) {
+    if (connectionAt(index).clientAddress.sin6_family != AF_UNIX) {
+        rearmQuickAck(pollDescriptors[index].fd, socketOptions);
+    }
 }
 
 bool ServerContext::hasMessageFrom(const int index) {
-    return readBuffers[index].networkMessageLen() > 0;
+    return connectionAt(index).readBuffer.networkMessageLen() > 0;
 }
 
 void ServerContext::checkIfEmpty(int index) {
-    if (not writeBuffers[index].hasMessage()) {
+    if (not connectionAt(index).writeBuffer.hasMessage()) {
         pollDescriptors[index].events = POLLIN;
     }
 }
 
-void ServerContext::initiateSending(int index, std::string message, CLIENT_STATE clientState) {
+bool ServerContext::hasPendingWriteAt(int index) {
+    return connectionAt(index).writeBuffer.hasMessage();
+}
+
+bool ServerContext::exceedsReadLimit(int index, size_t readLen) {
+    return connectionAt(index).readBuffer.buffer.size() + readLen > readLimit;
+}
+
+void ServerContext::checkWriteLimit(int index) {
+    Connection &connection = connectionAt(index);
+    if (not connection.overWriteLimit and connection.writeBuffer.pendingBytes > writeLimit) {
+        connection.overWriteLimit = true;
+        overWriteLimit.emplace_back(index);
+    }
+}
+
+void ServerContext::takeOverWriteLimit(std::vector<int> &indexes) {
+    indexes.clear();
+    indexes.swap(overWriteLimit);
+}
+
+bool ServerContext::isOverWriteLimit(int index) {
+    return connectionAt(index).overWriteLimit;
+}
+
+void ServerContext::initiateSending(int index, std::string_view message, CLIENT_STATE clientState,
+                                    std::string_view binaryMessage) {
     if (clientState != CLIENT_STATE::SENDING_WRONG) {
         stopWaitingFor(index);
     }
 
-    pollSetWrite(index);
+    if (not binaryMessage.empty()) {
+        appendMessageToWriteAt(index, message, binaryMessage);
+    } else if (not message.empty()) {
+        appendMessageToWriteAt(index, message);
+    }
 
-    if (not message.empty()) {
-        writeBuffers[index].appendMessage(message);
+    // Nothing is queued if message could not be encoded, and empty write would close client.
+    if (hasPendingWriteAt(index)) {
+        pollSetWrite(index);
     }
 
     if (clientState != CLIENT_STATE::SENDING_WRONG) {
-        clientStates[index] = clientState;
+        connectionAt(index).clientState = clientState;
     }
 }
 
 bool ServerContext::hasEveryoneReceivedPreviousTaken() {
     for (int index = 0; index < ServerConstants::ACCEPT_INDEX; index++) {
-        if (clientStates[index] == CLIENT_STATE::SENDING_PREVIOUS) {
+        if (connectionAt(index).clientState == CLIENT_STATE::SENDING_PREVIOUS) {
             return false;
         }
     }
@@ -261,34 +619,208 @@ void ServerContext::restoreEventsExceptIndexes() {
     storedIndexes.clear();
 }
 
+void ServerContext::setBinaryAt(int index) {
+    ReadBuffer &readBuffer = connectionAt(index).readBuffer;
+    readBuffer.binary = true;
+    readBuffer.scanned = 0;
+}
+
+bool ServerContext::isBinaryAt(int index) {
+    return connectionAt(index).readBuffer.binary;
+}
+
 void ServerContext::setClientStateAt(int index, CLIENT_STATE clientState) {
-    clientStates[index] = clientState;
+    connectionAt(index).clientState = clientState;
 }
 
 CLIENT_STATE ServerContext::getClientStateAt(int index) {
-    return clientStates[index];
+    return connectionAt(index).clientState;
 }
 
 std::string ServerContext::getCurrentWriteMessageAt(int index) {
-    return writeBuffers[index].getCurrentMessage();
+    Connection &connection = connectionAt(index);
+    if (connection.readBuffer.binary) {
+        return decodeBinary(connection.writeBuffer.getCurrentMessage());
+    }
+    return connection.writeBuffer.getCurrentMessage();
 }
 
 std::string ServerContext::getFirstWriteMessageAt(int index) {
-    return writeBuffers[index].getFirstMessage();
+    return connectionAt(index).writeBuffer.getFirstMessage();
+}
+
+void ServerContext::appendMessageToWriteAt(int index, std::string_view message) {
+    Connection &connection = connectionAt(index);
+    if (not connection.readBuffer.binary) {
+        connection.writeBuffer.appendMessage(message);
+    } else {
+        std::string encoded = encodeBinary(message);
+        if (encoded.empty()) {
+            error("cannot encode message for binary client %s: %.*s",
+                  getClientAddressStrAt(index).c_str(), (int)message.size(), message.data());
+            return;
+        }
+        connection.writeBuffer.appendMessage(encoded);
+    }
+    checkWriteLimit(index);
 }
 
-void ServerContext::appendMessageToWriteAt(int index, std::string message) {
-    writeBuffers[index].appendMessage(message);
+void ServerContext::appendMessageToWriteAt(int index, std::string_view message,
+                                           std::string_view binaryMessage) {
+    Connection &connection = connectionAt(index);
+    connection.writeBuffer.appendMessage(connection.readBuffer.binary ? binaryMessage : message);
+    checkWriteLimit(index);
 }
 
 bool ServerContext::wroteWholeMessageAt(int index, int sentLen) {
-    return writeBuffers[index].wroteWholeMessage(sentLen);
+    return connectionAt(index).writeBuffer.wroteWholeMessage(sentLen);
 }
 
-std::string ServerContext::popFirstReadMessageAt(int index) {
-    return readBuffers[index].popFirstNetworkMessage();
+std::string ServerContext::popFirstReadMessageAt(int index, CardsMessage &cardsMessage) {
+    ReadBuffer &readBuffer = connectionAt(index).readBuffer;
+    cardsMessage.parsed = false;
+    if (not readBuffer.binary) {
+        return readBuffer.popFirstNetworkMessage();
+    }
+
+    std::string message = readBuffer.popFirstNetworkMessage();
+    if (readCardsMessage(message, cardsMessage)) {
+        return std::string(getCardsMessageFrame(cardsMessage).view());
+    }
+    return std::string(decodeBinaryFrame(message).view());
 }
 
 void ServerContext::appendMessageToReadAt(int index, std::string message) {
-    readBuffers[index].appendRead(message);
+    connectionAt(index).readBuffer.appendRead(message);
+}
+
+void ServerContext::serialize(StateWriter &stateWriter) {
+    for (int index = ServerConstants::ACCEPT_INDEX; index <= ServerConstants::METRICS_INDEX;
+         index++) {
+        stateWriter.writeFd(pollDescriptors[index].fd);
+        stateWriter.writeInt(pollDescriptors[index].events);
+    }
+
+    stateWriter.writeInt(getSlotsNumber());
+    for (int index = 0; index < getSlotsNumber(); index++) {
+        if (index >= ServerConstants::ACCEPT_INDEX and index < ServerConstants::FIRST_CONNECTION) {
+            continue;
+        }
+
+        // Free slot is written as an absent descriptor only.
+        stateWriter.writeFd(pollDescriptors[index].fd);
+        if (not isDescriptorReserved(index)) {
+            continue;
+        }
+        stateWriter.writeInt(pollDescriptors[index].events);
+
+        Connection &connection = connectionAt(index);
+        stateWriter.writeInt(connection.socketTimeout);
+        stateWriter.writeInt(isWaitingFor(index));
+        stateWriter.writeString(std::string(
+            reinterpret_cast<const char *>(&connection.clientAddress), sizeof(sockaddr_in6)));
+        stateWriter.writeInt(static_cast<int>(connection.clientState));
+        stateWriter.writeString(connection.readBuffer.buffer);
+        stateWriter.writeInt(connection.readBuffer.binary);
+
+        stateWriter.writeString(connection.writeBuffer.currentMessage);
+        stateWriter.writeInt(connection.writeBuffer.messages.size());
+        for (const auto &message : connection.writeBuffer.messages) {
+            stateWriter.writeString(message);
+        }
+    }
+
+    stateWriter.writeInt(shmChannels.size());
+    for (auto &[index, channel] : shmChannels) {
+        stateWriter.writeInt(index);
+        stateWriter.writeFd(channel.getMemFd());
+    }
+
+    for (auto events : storedPollEvents) {
+        stateWriter.writeInt(events);
+    }
+    stateWriter.writeInt(storedIndexes.size());
+    for (auto index : storedIndexes) {
+        stateWriter.writeInt(index);
+    }
+}
+
+void ServerContext::deserialize(StateReader &stateReader) {
+    for (int index = ServerConstants::ACCEPT_INDEX; index <= ServerConstants::METRICS_INDEX;
+         index++) {
+        int fd = stateReader.readFd();
+        auto events = static_cast<short>(stateReader.readInt());
+        setPollDescriptor(index, fd, events);
+    }
+    socketFd = pollDescriptors[ServerConstants::ACCEPT_INDEX].fd;
+    unixSocketFd = pollDescriptors[ServerConstants::UNIX_ACCEPT_INDEX].fd;
+
+    int64_t slots = std::clamp<int64_t>(stateReader.readInt(), 0, ServerConstants::MAX_CONNECTIONS);
+    while (getSlotsNumber() < slots) {
+        addSlab();
+    }
+
+    for (int index = 0; index < slots and not stateReader.hasFailed(); index++) {
+        if (index >= ServerConstants::ACCEPT_INDEX and index < ServerConstants::FIRST_CONNECTION) {
+            continue;
+        }
+
+        int fd = stateReader.readFd();
+        if (fd < 0) {
+            resetPollDescriptor(index);
+            continue;
+        }
+        setPollDescriptor(index, fd, static_cast<short>(stateReader.readInt()));
+
+        Connection &connection = connectionAt(index);
+        connection.socketTimeout = (int)stateReader.readInt();
+        if (stateReader.readInt() != 0) {
+            startWaitingFor(index);
+        }
+
+        std::string address = stateReader.readString();
+        if (address.size() == sizeof(sockaddr_in6)) {
+            memcpy(&connection.clientAddress, address.data(), sizeof(sockaddr_in6));
+        }
+        connection.clientAddressStr.clear();
+        connection.serverAddressStr.clear();
+
+        connection.clientState = static_cast<CLIENT_STATE>(stateReader.readInt());
+        connection.readBuffer.buffer = stateReader.readString();
+        connection.readBuffer.scanned = 0;
+        connection.readBuffer.binary = stateReader.readInt() != 0;
+
+        connection.writeBuffer = WriteBuffer();
+        connection.writeBuffer.currentMessage = stateReader.readString();
+        int64_t messages = stateReader.readInt();
+        for (int64_t i = 0; i < messages and not stateReader.hasFailed(); i++) {
+            connection.writeBuffer.messages.emplace_back(stateReader.readString());
+            connection.writeBuffer.pendingBytes += connection.writeBuffer.messages.back().size();
+        }
+    }
+    rebuildFreeSlots();
+
+    int64_t channels = stateReader.readInt();
+    for (int64_t i = 0; i < channels and not stateReader.hasFailed(); i++) {
+        int index = (int)stateReader.readInt();
+        int memFd = stateReader.readFd();
+        if (index < 0 or index >= getSlotsNumber() or memFd < 0 or
+            not isDescriptorReserved(index)) {
+            continue;
+        }
+
+        ShmChannel channel;
+        if (channel.attach(memFd, pollDescriptors[index].fd, true)) {
+            shmChannels[index] = channel;
+        }
+    }
+
+    for (auto &events : storedPollEvents) {
+        events = static_cast<short>(stateReader.readInt());
+    }
+    storedIndexes.clear();
+    int64_t indexes = stateReader.readInt();
+    for (int64_t i = 0; i < indexes and not stateReader.hasFailed(); i++) {
+        storedIndexes.emplace_back((int)stateReader.readInt());
+    }
 }
@@ -4,37 +4,55 @@ void ServerCroupier::closeConnectionWithPlayer(int index) {
     serverContext.closeConnection(index, true);
     serverStatus.activePlayers--;
     serverStatus.setDealSentAt(index, false);
-}
 
-int ServerCroupier::findFreeSlot() {
-    int placeInPoll = Constants::ERROR_CODE;
-    for (int index = ServerConstants::ACCEPT_INDEX + 1; index < ServerConstants::CONNECTIONS;
-         ++index) {
-        if (serverContext.isDescriptorReserved(index)) {
-            continue;
-        }
+    // Think time of player who left before placing card ends here.
+    if (tableWait.waitsAt(FLOW_WAIT::TRICK, index)) {
+        report.addThink(index, microsSince(trickSentAt[index]));
+    }
+    tableWait.seatLeft(index);
+
+    if (botGrace >= 0 and serverStatus.gameStarted and not serverStatus.gameEnded) {
+        vacantSince[index] = std::chrono::steady_clock::now();
+    }
+
+    seatFromLobby(index);
+}
 
-        placeInPoll = index;
-        break;
+void ServerCroupier::closeConnectionWithNonPlayer(int index) {
+    if (serverContext.getClientStateAt(index) == CLIENT_STATE::IN_LOBBY) {
+        auto [place, position] = lobby.remove(index);
+        notifyLobby(place, position);
+    } else if (serverContext.getClientStateAt(index) == CLIENT_STATE::SPECTATING) {
+        spectatorFeed.removeSpectator(index);
     }
 
-    return placeInPoll;
+    serverContext.closeConnection(index, true);
+}
+
+int ServerCroupier::findFreeSlot() {
+    return serverContext.reserveSlot();
 }
 
 void ServerCroupier::prepareSendingWrong(int index) {
-    std::string wrongMessage = getWrongMessage(serverStatus);
-    serverContext.initiateSending(index, wrongMessage, CLIENT_STATE::SENDING_WRONG);
+    Frame wrongMessage = getWrongMessage(serverStatus);
+    serverContext.initiateSending(index, wrongMessage.view(), CLIENT_STATE::SENDING_WRONG);
+    metricsIncrement(METRIC_COUNTER::WRONG_SENT);
+    if (index < ServerConstants::ACCEPT_INDEX) {
+        report.addWrong(index);
+    }
 }
 
 void ServerCroupier::prepareSendingBusy(int index) {
-    std::string busyMessage = getBusyMessage(serverContext);
-    serverContext.initiateSending(index, busyMessage, CLIENT_STATE::SENDING_BUSY);
+    Frame busyMessage = getBusyMessage(serverContext);
+    serverContext.initiateSending(index, busyMessage.view(), CLIENT_STATE::SENDING_BUSY);
 }
 
 void ServerCroupier::prepareSendingDeal(int index, CLIENT_STATE clientState) {
     auto client_table_place = static_cast<TABLE_PLACE>(index);
 
-    if (serverStatus.dealSend[client_table_place]) {
+    // Seat played by server gets no messages.
+    if (serverStatus.dealSend[client_table_place] or
+        not serverContext.isDescriptorReserved(index)) {
         return;
     }
 
@@ -44,95 +62,83 @@ void ServerCroupier::prepareSendingDeal(int index, CLIENT_STATE clientState) {
     serverStatus.setDealSentAt(index, true);
 }
 
-void ServerCroupier::afterSendingDeal(int index) {
-    if (serverStatus.getCurrentTablePlace() == index) {
-        prepareSendingTrick(index);
-    } else {
-        serverContext.setClientStateAt(index, CLIENT_STATE::WAITING_FOR_TURN);
-    }
-}
-
 void ServerCroupier::prepareSendingTrick(int index) {
-    std::string trickMessage = getTrickMessage(serverStatus);
-    serverContext.initiateSending(index, trickMessage, CLIENT_STATE::SENDING_TRICK);
+    Frame trickMessage = getTrickMessage(serverStatus);
+    Frame binaryTrickMessage = getBinaryTrickMessage(serverStatus);
+    serverContext.initiateSending(index, trickMessage.view(), CLIENT_STATE::SENDING_TRICK,
+                                  binaryTrickMessage.view());
+
+    if (not trickPublished) {
+        spectatorFeed.appendEvent(trickMessage.view(), serverContext);
+        trickPublished = true;
+    }
 }
 
 void ServerCroupier::afterSendingTrick(int index) {
+    trickSentAt[index] = std::chrono::steady_clock::now();
     serverContext.startWaitingFor(index);
     serverContext.resetTimeout(index);
     serverContext.setClientStateAt(index, CLIENT_STATE::WAITING_FOR_TRICK);
 }
 
 void ServerCroupier::prepareSendingTaken() {
-    int currentHand = serverStatus.currentHand;
-    std::string takenStr = getTakenStr(serverStatus.hands[currentHand]);
-    serverStatus.hands[currentHand].previousTaken.emplace_back(takenStr);
-
-    serverStatus.setCurrentTablePlace(serverStatus.getPreviousTrickTaker());
-
-    serverStatus.clearCardsFromTable();
+    auto [takenMessage, binaryTakenMessage] = serverStatus.takeTrick();
 
     for (int i = 0; i < ServerConstants::ACCEPT_INDEX; i++) {
-        serverContext.initiateSending(i, takenStr, CLIENT_STATE::SENDING_TAKEN);
+        if (serverContext.isDescriptorReserved(i)) {
+            serverContext.initiateSending(i, takenMessage.view(), CLIENT_STATE::WAITING_FOR_TURN,
+                                          binaryTakenMessage.view());
+        }
     }
+    spectatorFeed.appendEvent(takenMessage.view(), serverContext);
 }
 
-void ServerCroupier::afterSendingTaken(int index) {
-    if (not canBeScore(serverContext.getCurrentWriteMessageAt(index))) {
-        if (serverStatus.getCurrentTablePlace() == index) {
-            prepareSendingTrick(index);
-        } else {
-            serverContext.setClientStateAt(index, CLIENT_STATE::WAITING_FOR_TURN);
-        }
-    } else {
-        serverContext.setClientStateAt(index, CLIENT_STATE::SENDING_SCORE);
+void ServerCroupier::publishDeals() {
+    spectatorFeed.startHand();
+
+    ServerHand &hand = serverStatus.getCurrentHand();
+    for (int i = 0; i < Constants::PLAYERS_NUMBER; i++) {
+        spectatorFeed.appendEvent(hand.dealStrAtPlace[static_cast<TABLE_PLACE>(i)],
+                                  serverContext);
     }
 }
 
 void ServerCroupier::afterSendingPrevious(int index) {
-    if (canBeTaken(serverContext.getCurrentWriteMessageAt(index))) {
-        return;
-    }
-
     serverContext.setClientStateAt(index, CLIENT_STATE::WAITING_FOR_TURN);
     if (serverContext.hasEveryoneReceivedPreviousTaken()) {
         serverContext.restoreEventsExceptIndexes();
     }
 
-    if (serverStatus.getCurrentTablePlace() == index) {
-        prepareSendingTrick(index);
-    }
+    resumeIfTableReady();
 }
 
 void ServerCroupier::prepareSendingScore(int index) {
-    std::string resultsMessage = getResultsMessage(serverStatus, Messages::SCORE);
-    serverContext.appendMessageToWriteAt(index, resultsMessage);
     serverStatus.updatePlayerTotalScore(index);
-}
+    if (not serverContext.isDescriptorReserved(index)) {
+        return;
+    }
 
-void ServerCroupier::afterSendingScore(int index) {
-    serverContext.setClientStateAt(index, CLIENT_STATE::SENDING_TOTAL);
+    Frame resultsMessage = getResultsMessage(serverStatus, Messages::SCORE);
+    serverContext.appendMessageToWriteAt(index, resultsMessage.view());
 }
 
 void ServerCroupier::prepareSendingTotal(int index) {
-    std::string resultsMessage = getResultsMessage(serverStatus, Messages::TOTAL);
-    serverContext.appendMessageToWriteAt(index, resultsMessage);
-}
-
-void ServerCroupier::afterSendingTotal(int index) {
-    if (serverStatus.gameEnded) {
-        serverStatus.alreadyLeft[static_cast<TABLE_PLACE>(index)] = true;
-
-        closeConnectionWithPlayer(index);
+    if (not serverContext.isDescriptorReserved(index)) {
         return;
     }
 
-    serverStatus.dealSend[static_cast<TABLE_PLACE>(index)] = false;
-    prepareSendingDeal(index, CLIENT_STATE::SENDING_DEAL);
+    Frame resultsMessage = getResultsMessage(serverStatus, Messages::TOTAL);
+    serverContext.appendMessageToWriteAt(index, resultsMessage.view());
 }
 
 void ServerCroupier::startClosingWaiting() {
-    for (int index = ServerConstants::ACCEPT_INDEX + 1; index < ServerConstants::CONNECTIONS;
+    // Waiting clients will be parked in lobby or get busy after they send IAM, because some of
+    // them may want to spectate or take seat over from server.
+    if (lobbyEnabled or spectatorsEnabled or getBotSeatsNumber() > 0) {
+        return;
+    }
+
+    for (int index = ServerConstants::FIRST_CONNECTION; index < serverContext.getSlotsNumber();
          index++) {
         if (serverContext.isDescriptorReserved(index)) {
             prepareSendingBusy(index);
@@ -140,16 +146,220 @@ void ServerCroupier::startClosingWaiting() {
     }
 }
 
+TableFlow ServerCroupier::playTable() {
+    while (not serverStatus.gameEnded) {
+        // Started game stalls until players who left come back or server takes their seats.
+        bool stalled = serverStatus.gameStarted and not isTableReady();
+        auto stallStart = std::chrono::steady_clock::now();
+        co_await tableReady();
+        if (stalled) {
+            report.addStall(microsSince(stallStart));
+        }
+
+        int seat = serverStatus.getCurrentTablePlace();
+
+        // Server plays seat of player who did not come back at once.
+        if (botSeats[seat]) {
+            playForBot(seat);
+            continue;
+        }
+
+        CLIENT_STATE seatState = serverContext.getClientStateAt(seat);
+
+        // After hot upgrade trick may be already queued or sent.
+        if (seatState != CLIENT_STATE::WAITING_FOR_TRICK) {
+            if (seatState != CLIENT_STATE::SENDING_TRICK) {
+                prepareSendingTrick(seat);
+            }
+
+            if (co_await sent(seat) != SEAT_EVENT::DONE) {
+                continue;
+            }
+            afterSendingTrick(seat);
+        }
+
+        SEAT_EVENT event = co_await trickFrom(seat);
+        if (event == SEAT_EVENT::DONE) {
+            afterReceivingTrick(seat);
+        } else if (event == SEAT_EVENT::TIMED_OUT) {
+            // Trick is sent again.
+            serverContext.setClientStateAt(seat, CLIENT_STATE::WAITING_FOR_TURN);
+        }
+    }
+
+    // Players are disconnected once they receive final TOTAL.
+    for (int seat = 0; seat < Constants::PLAYERS_NUMBER; seat++) {
+        if (co_await sent(seat) == SEAT_EVENT::DONE) {
+            closeConnectionWithPlayer(seat);
+        }
+        serverStatus.alreadyLeft[static_cast<TABLE_PLACE>(seat)] = true;
+    }
+}
+
+SeatAwaiter ServerCroupier::tableReady() {
+    return {tableWait, FLOW_WAIT::TABLE_READY, -1, isTableReady()};
+}
+
+SeatAwaiter ServerCroupier::sent(int seat) {
+    if (not serverContext.isDescriptorReserved(seat)) {
+        return {tableWait, FLOW_WAIT::SENT, seat, true, SEAT_EVENT::LEFT};
+    }
+    return {tableWait, FLOW_WAIT::SENT, seat, not serverContext.hasPendingWriteAt(seat)};
+}
+
+SeatAwaiter ServerCroupier::trickFrom(int seat) {
+    if (not serverContext.isDescriptorReserved(seat)) {
+        return {tableWait, FLOW_WAIT::TRICK, seat, true, SEAT_EVENT::LEFT};
+    }
+    return {tableWait, FLOW_WAIT::TRICK, seat, false};
+}
+
+bool ServerCroupier::isTableReady() {
+    return serverStatus.isGameActive() and serverContext.hasEveryoneReceivedPreviousTaken() and
+           serverStatus.activePlayers > getBotSeatsNumber();
+}
+
+void ServerCroupier::resumeIfTableReady() {
+    if (isTableReady()) {
+        tableWait.resume(FLOW_WAIT::TABLE_READY, -1, SEAT_EVENT::DONE);
+    }
+}
+
+void ServerCroupier::startNextGame() {
+    auto restartStart = std::chrono::steady_clock::now();
+
+    // Copy assignment reuses memory of previous game.
+    currentGame = (currentGame + 1) % games.size();
+    serverStatus = games[currentGame];
+    vacantSince.clear();
+    std::fill(std::begin(botSeats), std::end(botSeats), false);
+    spectatorFeed.startGame();
+
+    journal.openJournal(journalPath, serverStatus, false);
+
+    tableFlow = playTable();
+    tableFlow.start();
+
+    // Clients who came while previous game was ending are seated now.
+    for (int seat = 0; seat < Constants::PLAYERS_NUMBER; seat++) {
+        seatFromLobby(seat);
+    }
+    for (int index = ServerConstants::FIRST_CONNECTION; index < serverContext.getSlotsNumber();
+         index++) {
+        if (serverContext.isDescriptorReserved(index) and serverContext.hasMessageFrom(index)) {
+            handleNonPlayerMessage(index);
+        }
+    }
+
+    metricsObserve(METRIC_HISTOGRAM::GAME_RESTART_TIME, microsSince(restartStart));
+}
+
+int ServerCroupier::getBotSeatsNumber() {
+    int bots = 0;
+    for (bool botSeat : botSeats) {
+        bots += botSeat;
+    }
+    return bots;
+}
+
+int ServerCroupier::getBotTimeout() {
+    int timeout = Constants::ERROR_CODE;
+    for (auto &[seat, since] : vacantSince) {
+        int left = std::max<int64_t>(botGrace - (int64_t)microsSince(since) / 1000, 0);
+        timeout = timeout < 0 ? left : std::min(timeout, left);
+    }
+    return timeout;
+}
+
+void ServerCroupier::handleVacantSeats() {
+    for (auto it = vacantSince.begin(); it != vacantSince.end();) {
+        if ((int64_t)microsSince(it->second) < (int64_t)botGrace * 1000) {
+            it++;
+            continue;
+        }
+
+        botSeats[it->first] = true;
+        serverStatus.activePlayers++;
+        metricsIncrement(METRIC_COUNTER::BOT_SUBSTITUTIONS);
+        it = vacantSince.erase(it);
+
+        resumeIfTableReady();
+    }
+}
+
+void ServerCroupier::playForBot(int seat) {
+    auto place = static_cast<TABLE_PLACE>(seat);
+    serverStatus.playerPlacesCard(place, serverStatus.getBotCard(place));
+    metricsIncrement(METRIC_COUNTER::BOT_CARDS);
+    report.addBotCard(seat);
+
+    afterPlacingCard(seat);
+}
+
+void ServerCroupier::parkInLobby(int index, TABLE_PLACE place) {
+    int position = lobby.park(place, index);
+    serverContext.initiateSending(index, getQueueFrame(position).view(), CLIENT_STATE::IN_LOBBY);
+}
+
+void ServerCroupier::notifyLobby(TABLE_PLACE place, int fromPosition) {
+    std::deque<int> &queue = lobby.waitingAt[place];
+
+    for (int position = fromPosition; position <= (int)queue.size(); position++) {
+        serverContext.initiateSending(queue[position - 1], getQueueFrame(position).view(),
+                                      CLIENT_STATE::IN_LOBBY);
+    }
+}
+
+void ServerCroupier::seatFromLobby(int index) {
+    auto place = static_cast<TABLE_PLACE>(index);
+    if (not lobbyEnabled or serverStatus.gameEnded or not lobby.hasWaiting(place)) {
+        return;
+    }
+
+    int lobbyIndex = lobby.popFirst(place);
+    notifyLobby(place, 1);
+
+    seatPlayer(lobbyIndex, place);
+}
+
+void ServerCroupier::closeLobby() {
+    for (auto &[place, queue] : lobby.waitingAt) {
+        for (int index : queue) {
+            prepareSendingBusy(index);
+        }
+        queue.clear();
+    }
+}
+
 TABLE_PLACE ServerCroupier::handleNonPlayerBuffer(int index) {
     bool alreadyHandledIam = false;
     TABLE_PLACE clientPlace = TABLE_PLACE::UNDEFINED;
 
+    CardsMessage trick;
     while (serverContext.hasMessageFrom(index)) {
-        std::string clientMessage = serverContext.popFirstReadMessageAt(index);
+        std::string clientMessage = serverContext.popFirstReadMessageAt(index, trick);
         serverContext.displayMessageFromClient(index, clientMessage);
 
-        if (serverContext.getClientStateAt(index) == CLIENT_STATE::SENDING_BUSY) {
-            continue; // If we are sending busy we do not care about messages.
+        CLIENT_STATE clientState = serverContext.getClientStateAt(index);
+        if (clientState == CLIENT_STATE::SENDING_BUSY or clientState == CLIENT_STATE::IN_LOBBY or
+            clientState == CLIENT_STATE::SPECTATING) {
+            continue; // If we are sending busy, client waits in lobby or spectates we do not care.
+        }
+
+        // Bot on this host asks for shared memory before IAM and waits for the reply.
+        if (not alreadyHandledIam and parseShm(clientMessage)) {
+            if (not serverContext.upgradeToShm(index, clientMessage)) {
+                serverContext.closeConnection(index, true);
+                return TABLE_PLACE::UNDEFINED;
+            }
+
+            serverContext.displayMessageFromServer(index, clientMessage);
+            continue;
+        }
+
+        if (not alreadyHandledIam and spectatorsEnabled and parseSpectate(clientMessage)) {
+            spectatorFeed.addSpectator(index, serverContext);
+            continue;
         }
 
         if (not alreadyHandledIam) { // First message should be IAM.
@@ -158,17 +368,24 @@ TABLE_PLACE ServerCroupier::handleNonPlayerBuffer(int index) {
                 serverContext.closeConnection(index, true);
                 return TABLE_PLACE::UNDEFINED;
             }
+            if (asksForBinary(clientMessage)) {
+                serverContext.setBinaryAt(index);
+            }
 
             int clientPlaceInt = static_cast<int>(clientPlace);
             if (serverContext.isDescriptorReserved(clientPlaceInt)) {
-                prepareSendingBusy(index);
+                if (lobbyEnabled and not serverStatus.gameEnded) {
+                    parkInLobby(index, clientPlace);
+                } else {
+                    prepareSendingBusy(index);
+                }
                 continue;
             }
 
             // If we are here that means we parsed IAM correctly.
             alreadyHandledIam = true;
         } else { // We already handled IAM message.
-            if (not canTrickBeParsed(clientMessage)) {
+            if (not canTrickBeParsed(clientMessage, trick)) {
                 serverContext.closeConnection(index, true);
                 return TABLE_PLACE::UNDEFINED;
             }
@@ -185,21 +402,43 @@ TABLE_PLACE ServerCroupier::handleNonPlayerBuffer(int index) {
 }
 
 void ServerCroupier::handleNonPlayerMessage(int index) {
+    // Daemon keeps messages of clients until next game starts.
+    if (daemonEnabled and serverStatus.gameEnded) {
+        return;
+    }
+
     TABLE_PLACE clientPlace = handleNonPlayerBuffer(index);
     if (clientPlace == TABLE_PLACE::UNDEFINED) {
         return;
     }
 
+    seatPlayer(index, clientPlace);
+}
+
+void ServerCroupier::seatPlayer(int index, TABLE_PLACE clientPlace) {
     int clientPlaceInt = static_cast<int>(clientPlace);
 
+    // Player takes seat over from server.
+    vacantSince.erase(clientPlaceInt);
+    if (botSeats[clientPlaceInt]) {
+        botSeats[clientPlaceInt] = false;
+        serverStatus.activePlayers--;
+    }
+
     serverContext.movePlayer(index, clientPlaceInt);
     serverStatus.activePlayers++;
 
     if (serverStatus.gameStarted) {
         serverContext.setClientStateAt(clientPlaceInt, CLIENT_STATE::SENDING_PREVIOUS);
+        report.addReconnect(clientPlaceInt);
     }
 
     if (serverStatus.isGameActive()) {
+        if (not serverStatus.gameStarted) {
+            metricsAddGauge(METRIC_GAUGE::ACTIVE_TABLES, 1);
+            publishDeals();
+            report.startGame();
+        }
         serverStatus.gameStarted = true;
         startClosingWaiting();
 
@@ -216,15 +455,18 @@ void ServerCroupier::handleNonPlayerMessage(int index) {
         if (not newPlayers.empty()) {
             serverContext.storeEventsExceptIndexes(newPlayers);
         }
+
+        resumeIfTableReady();
     }
 }
 
 void ServerCroupier::handleNonCurrentMessage(int index) {
+    CardsMessage trick;
     while (serverContext.hasMessageFrom(index)) {
-        std::string clientMessage = serverContext.popFirstReadMessageAt(index);
+        std::string clientMessage = serverContext.popFirstReadMessageAt(index, trick);
         serverContext.displayMessageFromClient(index, clientMessage);
 
-        if (not canTrickBeParsed(clientMessage)) {
+        if (not canTrickBeParsed(clientMessage, trick)) {
             closeConnectionWithPlayer(index);
             return;
         }
@@ -234,28 +476,31 @@ void ServerCroupier::handleNonCurrentMessage(int index) {
 }
 
 void ServerCroupier::afterReceivingTrick(int index) {
+    uint64_t thinkTime = microsSince(trickSentAt[index]);
+    metricsObserve(METRIC_HISTOGRAM::THINK_TIME, thinkTime);
+    report.addThink(index, thinkTime);
     serverContext.stopWaitingFor(index);
     serverContext.resetTimeout(index);
     serverContext.setClientStateAt(index, CLIENT_STATE::WAITING_FOR_TURN);
 
-    int nextClientInt = (index + 1) % Constants::PLAYERS_NUMBER;
-    auto nextClient = static_cast<TABLE_PLACE>(nextClientInt);
+    afterPlacingCard(index);
+}
+
+void ServerCroupier::afterPlacingCard(int index) {
+    trickPublished = false;
+    journal.logCard(serverStatus.currentHand, static_cast<TABLE_PLACE>(index),
+                    serverStatus.getCurrentHand().currentlyPlacedCards.back());
 
+    auto nextClient = static_cast<TABLE_PLACE>((index + 1) % Constants::PLAYERS_NUMBER);
     serverStatus.setCurrentTablePlace(nextClient);
 
     // Server checks if it has received 4 cards.
     if (serverStatus.getPreviousTrickTaker() != nextClient) {
-        // If server is communicating with next client, it will send trick after communication.
-        if (serverContext.getClientStateAt(nextClientInt) != CLIENT_STATE::WAITING_FOR_TURN) {
-            return;
-        }
-
-        // Otherwise we initiate sending trick message.
-        prepareSendingTrick(nextClientInt);
         return;
     }
 
     prepareSendingTaken();
+    report.finishTrick(serverStatus.currentHand + 1, serverStatus.getCurrentTrick());
 
     serverStatus.finishTrick();
     if (not serverStatus.hasHandEnded()) {
@@ -265,33 +510,55 @@ void ServerCroupier::afterReceivingTrick(int index) {
     for (int i = 0; i < ServerConstants::ACCEPT_INDEX; i++) {
         prepareSendingScore(i);
     }
+    spectatorFeed.appendEvent(getResultsMessage(serverStatus, Messages::SCORE).view(),
+                              serverContext);
 
     for (int i = 0; i < ServerConstants::ACCEPT_INDEX; i++) {
         prepareSendingTotal(i);
     }
+    spectatorFeed.appendEvent(getResultsMessage(serverStatus, Messages::TOTAL).view(),
+                              serverContext);
 
     for (int i = 0; i < ServerConstants::ACCEPT_INDEX; i++) {
         serverStatus.setDealSentAt(i, false);
     }
 
     serverStatus.finishHand();
+    if (serverStatus.gameEnded) {
+        metricsAddGauge(METRIC_GAUGE::ACTIVE_TABLES, -1);
+        metricsIncrement(METRIC_COUNTER::GAMES_PLAYED);
+        if (not daemonEnabled) {
+            closeLobby(); // Daemon seats lobby in next game.
+        }
+        journal.finish();
+        report.finishGame();
+    } else {
+        publishDeals();
+        journal.writeSnapshot(serverStatus);
+
+        // Deals of next hand are queued right behind TOTAL.
+        for (int i = 0; i < ServerConstants::ACCEPT_INDEX; i++) {
+            prepareSendingDeal(i, CLIENT_STATE::WAITING_FOR_TURN);
+        }
+    }
 }
 
 void ServerCroupier::handleCurrentMessage(int index) {
     auto currentPlayer = static_cast<TABLE_PLACE>(index);
     bool alreadyHandledTrick = false;
 
+    CardsMessage trick;
     while (serverContext.hasMessageFrom(index)) {
-        std::string clientMessage = serverContext.popFirstReadMessageAt(index);
+        std::string clientMessage = serverContext.popFirstReadMessageAt(index, trick);
         serverContext.displayMessageFromClient(index, clientMessage);
 
         if (not alreadyHandledTrick and
-            parseTrickServer(clientMessage, serverStatus, currentPlayer)) {
+            parseTrickServer(clientMessage, trick, serverStatus, currentPlayer)) {
             alreadyHandledTrick = true;
             continue;
         }
 
-        if (not canTrickBeParsed(clientMessage)) {
+        if (not canTrickBeParsed(clientMessage, trick)) {
             closeConnectionWithPlayer(index);
             return;
         }
@@ -303,16 +570,33 @@ void ServerCroupier::handleCurrentMessage(int index) {
         return;
     }
 
-    afterReceivingTrick(index);
+    tableWait.resume(FLOW_WAIT::TRICK, index, SEAT_EVENT::DONE);
 }
 
 void ServerCroupier::handlePlayersBuffer() {
+    // Seats are taken out on every path. Closing a player while reading may pause the table
+    // after other seats were queued, and they must not stay queued for a later iteration.
+    handledPlayers.clear();
+    handledPlayers.swap(playersWithInput);
+
     if (not serverStatus.pollIncludesPlayers()) {
+        pausedPlayerInput = pausedPlayerInput or not handledPlayers.empty();
         return;
     }
 
-    for (int index = 0; index < ServerConstants::ACCEPT_INDEX; index++) {
-        if (serverContext.getClientStateAt(index) == CLIENT_STATE::WAITING_FOR_TRICK) {
+    // Seats that left meanwhile have empty buffers, so only messages still waiting are found.
+    if (pausedPlayerInput) {
+        pausedPlayerInput = false;
+        handledPlayers.clear();
+        for (int index = 0; index < ServerConstants::ACCEPT_INDEX; index++) {
+            if (serverContext.hasMessageFrom(index)) {
+                handledPlayers.emplace_back(index);
+            }
+        }
+    }
+
+    for (int index : handledPlayers) {
+        if (tableWait.waitsAt(FLOW_WAIT::TRICK, index)) {
             handleCurrentMessage(index);
         } else {
             handleNonCurrentMessage(index);
@@ -320,24 +604,28 @@ void ServerCroupier::handlePlayersBuffer() {
     }
 }
 
-void ServerCroupier::handleNewConnection() {
-    if (not serverContext.pollReadAt(ServerConstants::ACCEPT_INDEX)) {
-        return;
-    }
-
-    struct sockaddr_in6 clientAddress;
-    socklen_t clientAddressLen = sizeof(clientAddress);
-    memset(&clientAddress, 0, clientAddressLen);
+void ServerCroupier::rejectConnection(int clientFd, const sockaddr_in6 &clientAddress) {
+    const std::string &message = ServerConstants::GAME_FULL_MESSAGE;
 
-    int clientFd = accept(serverContext.getPollDescriptor(ServerConstants::ACCEPT_INDEX),
-                          (struct sockaddr *)&clientAddress, &clientAddressLen);
-    if (clientFd < 0) {
-        sysError("accept");
-        return;
+    // Fresh socket has empty send buffer, so BUSY is either written at once or not at all.
+    ssize_t sentLen = send(clientFd, message.c_str(), message.size(), MSG_DONTWAIT);
+    if (sentLen == (ssize_t)message.size()) {
+        metricsIncrement(METRIC_COUNTER::BUSY_SENT);
+        display(getLocalAddressStr(clientFd, clientAddress),
+                getClientAddressStr(clientFd, clientAddress), message);
     }
 
-    if (fcntl(clientFd, F_SETFL, O_NONBLOCK)) {
-        sysError("fcntl");
+    close(clientFd);
+}
+
+void ServerCroupier::acceptNewConnection(int clientFd, const sockaddr_in6 &clientAddress) {
+    // Clients connecting to an active game wait in lobby or spectate if it is enabled. Seats
+    // played by server are given back to their players.
+    bool isGameFull = (serverStatus.gameEnded and not daemonEnabled) or
+                      (serverStatus.isGameActive() and not lobbyEnabled and not spectatorsEnabled and
+                       getBotSeatsNumber() == 0);
+    if (isGameFull) {
+        rejectConnection(clientFd, clientAddress);
         return;
     }
 
@@ -348,31 +636,55 @@ void ServerCroupier::handleNewConnection() {
         return;
     }
 
-    // Setting client ip.
-    std::string clientIp = getIpv6AndPortAddress(clientAddress);
+    serverContext.acceptConnection(placeInPoll, clientFd, clientAddress);
+}
 
-    struct sockaddr_in6 serverAddress;
-    socklen_t serverAddressLen = sizeof(serverAddress);
-    memset(&serverAddress, 0, serverAddressLen);
-    // Find out what port the server is actually listening on.
-    if (getsockname(clientFd, (struct sockaddr *)&serverAddress, &serverAddressLen) < 0) {
-        sysError("getsockname");
+void ServerCroupier::acceptPending(int acceptIndex) {
+    if (not serverContext.pollReadAt(acceptIndex)) {
         return;
     }
 
-    std::string serverIp = getIpv6AndPortAddress(serverAddress);
+    // Drain accept queue, so bursts of connections do not overflow the backlog.
+    while (true) {
+        struct sockaddr_in6 clientAddress;
+        socklen_t clientAddressLen = sizeof(clientAddress);
+
+        int clientFd = accept4(serverContext.getPollDescriptor(acceptIndex),
+                               (struct sockaddr *)&clientAddress, &clientAddressLen,
+                               SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (clientFd < 0) {
+            if (errno == EINTR or errno == ECONNABORTED) {
+                continue;
+            }
+
+            if (errno != EAGAIN and errno != EWOULDBLOCK) {
+                sysError("accept");
+            }
+            return;
+        }
+
+        // Unix peers have no address worth keeping, only its family marks the connection.
+        if (clientAddress.sin6_family == AF_UNIX) {
+            memset(&clientAddress, 0, sizeof(clientAddress));
+            clientAddress.sin6_family = AF_UNIX;
+        }
+
+        metricsIncrement(METRIC_COUNTER::CONNECTIONS_ACCEPTED);
+        acceptNewConnection(clientFd, clientAddress);
+    }
+}
 
-    bool isGameFull = serverStatus.isGameActive() or serverStatus.gameEnded;
-    serverContext.acceptConnection(placeInPoll, clientFd, isGameFull, clientIp, serverIp);
+void ServerCroupier::handleNewConnection() {
+    acceptPending(ServerConstants::ACCEPT_INDEX);
+    acceptPending(ServerConstants::UNIX_ACCEPT_INDEX);
 }
 
 void ServerCroupier::handleTimeout() {
-    for (int index = ServerConstants::ACCEPT_INDEX + 1; index < ServerConstants::CONNECTIONS;
-         index++) {
-        if (not serverContext.timeoutAt(index)) {
-            continue;
-        }
+    timedOut.clear();
+    serverContext.collectTimedOut(ServerConstants::FIRST_CONNECTION, timedOut);
+    for (int index : timedOut) {
         // Server waited for IAM and timed out.
+        metricsIncrement(METRIC_COUNTER::IAM_TIMEOUTS);
         serverContext.closeConnection(index, true);
     }
 
@@ -385,21 +697,34 @@ void ServerCroupier::handleTimeout() {
             continue;
         } // Server waited for TRICK and timed out.
 
-        prepareSendingTrick(index);
+        metricsIncrement(METRIC_COUNTER::TRICK_TIMEOUTS);
+        report.addThink(index, microsSince(trickSentAt[index]));
+        report.addTimeout(index);
+        serverContext.stopWaitingFor(index);
+        tableWait.resume(FLOW_WAIT::TRICK, index, SEAT_EVENT::TIMED_OUT);
     }
 }
 
 void ServerCroupier::readFromNonPlayer(const int index, char *buffer) {
     // Server reads from new client.
-    ssize_t readLen =
-        read(serverContext.getPollDescriptor(index), buffer, ServerConstants::BUFFER_SIZE);
+    ssize_t readLen = serverContext.receiveAt(index, buffer, ServerConstants::BUFFER_SIZE);
 
     if (readLen <= 0) {
+        if (readLen < 0 and errno == EAGAIN) {
+            return; // Only a doorbell of shared memory.
+        }
         if (readLen < 0) {
             sysError("read");
         }
 
-        serverContext.closeConnection(index, true);
+        closeConnectionWithNonPlayer(index);
+        return;
+    }
+
+    metricsIncrement(METRIC_COUNTER::BYTES_IN, readLen);
+    if (serverContext.exceedsReadLimit(index, readLen)) {
+        metricsIncrement(METRIC_COUNTER::LIMIT_EVICTIONS);
+        closeConnectionWithNonPlayer(index);
         return;
     }
 
@@ -410,10 +735,30 @@ void ServerCroupier::readFromNonPlayer(const int index, char *buffer) {
     handleNonPlayerMessage(index);
 }
 
+void ServerCroupier::evictOverWriteLimit() {
+    serverContext.takeOverWriteLimit(evicted);
+
+    for (int index : evicted) {
+        // Slot may have been closed and reused since it was marked.
+        if (not serverContext.isOverWriteLimit(index)) {
+            continue;
+        }
+
+        metricsIncrement(METRIC_COUNTER::LIMIT_EVICTIONS);
+        if (index < ServerConstants::ACCEPT_INDEX) {
+            if (serverStatus.gameEnded) {
+                serverStatus.alreadyLeft[static_cast<TABLE_PLACE>(index)] = true;
+            }
+            closeConnectionWithPlayer(index);
+        } else {
+            closeConnectionWithNonPlayer(index);
+        }
+    }
+}
+
 void ServerCroupier::readFromNonPlayers(char *buffer) {
-    for (int index = ServerConstants::ACCEPT_INDEX + 1; index < ServerConstants::CONNECTIONS;
-         index++) {
-        if (serverContext.pollReadAt(index)) {
+    for (int index : serverContext.getReadyToRead()) {
+        if (index >= ServerConstants::FIRST_CONNECTION and serverContext.pollReadAt(index)) {
             readFromNonPlayer(index, buffer);
         }
     }
@@ -424,16 +769,21 @@ void ServerCroupier::readFromPlayers(char *buffer) {
         return;
     }
 
-    for (int index = 0; index < ServerConstants::ACCEPT_INDEX; index++) {
+    for (int index : serverContext.getReadyToRead()) {
+        if (index >= ServerConstants::ACCEPT_INDEX) {
+            break; // Ready connections are sorted, so there are no more players.
+        }
         if (not serverContext.pollReadAt(index)) {
             continue;
         }
         // There is something to read.
 
-        ssize_t readLen =
-            read(serverContext.getPollDescriptor(index), buffer, ServerConstants::BUFFER_SIZE);
+        ssize_t readLen = serverContext.receiveAt(index, buffer, ServerConstants::BUFFER_SIZE);
 
         if (readLen <= 0) {
+            if (readLen < 0 and errno == EAGAIN) {
+                continue; // Only a doorbell of shared memory.
+            }
             if (readLen < 0) {
                 sysError("read");
             }
@@ -446,21 +796,32 @@ void ServerCroupier::readFromPlayers(char *buffer) {
             continue;
         }
 
+        metricsIncrement(METRIC_COUNTER::BYTES_IN, readLen);
+        serverContext.rearmQuickAckAt(index);
+        if (serverContext.exceedsReadLimit(index, readLen)) {
+            metricsIncrement(METRIC_COUNTER::LIMIT_EVICTIONS);
+            if (serverStatus.gameEnded) {
+                serverStatus.alreadyLeft[static_cast<TABLE_PLACE>(index)] = true;
+            }
+
+            closeConnectionWithPlayer(index);
+            continue;
+        }
+
         std::string readMsg(buffer, readLen);
         serverContext.appendMessageToReadAt(index, readMsg);
+        playersWithInput.emplace_back(index);
     }
 }
 
-bool ServerCroupier::serverSentBusy(int index, ssize_t sentLen) {
-    std::string message = serverContext.getCurrentWriteMessageAt(index);
-
-    return serverContext.wroteWholeMessageAt(index, sentLen) and not canBeWrong(message);
-}
-
 void ServerCroupier::writeToNonPlayers() {
-    for (int index = ServerConstants::ACCEPT_INDEX + 1; index < ServerConstants::CONNECTIONS;
-         index++) {
-        if (not serverContext.pollWriteAt(index)) {
+    for (int index : serverContext.getReadyToWrite()) {
+        if (index < ServerConstants::FIRST_CONNECTION or not serverContext.pollWriteAt(index)) {
+            continue;
+        }
+
+        if (serverContext.getClientStateAt(index) == CLIENT_STATE::SPECTATING) {
+            spectatorFeed.writeToSpectator(index, serverContext);
             continue;
         }
 
@@ -468,34 +829,37 @@ void ServerCroupier::writeToNonPlayers() {
         ssize_t sentLen = serverContext.sendMessageServer(index, message);
         if (sentLen <= 0) {
             if (sentLen < 0 and (errno == EAGAIN or errno == EWOULDBLOCK)) {
-                return;
+                continue;
             }
 
-            serverContext.closeConnection(index, true);
+            closeConnectionWithNonPlayer(index);
+            continue;
         }
 
-        if (serverSentBusy(index, sentLen)) {
-            serverContext.displayMessageFromServer(index, message);
-            serverContext.closeConnection(index, true);
+        std::string currentMessage = serverContext.getCurrentWriteMessageAt(index);
+
+        if (not serverContext.wroteWholeMessageAt(index, sentLen)) {
+            continue;
         }
-    }
-}
 
-void ServerCroupier::writeToPlayers() {
-    if (not serverStatus.pollIncludesPlayers()) {
-        return;
-    }
+        serverContext.displayMessageFromServer(index, currentMessage);
+        serverContext.checkIfEmpty(index);
 
-    for (int index = 0; index < ServerConstants::ACCEPT_INDEX; index++) {
-        if (not serverContext.pollWriteAt(index)) {
-            continue;
+        if (canBeBusy(currentMessage)) {
+            metricsIncrement(METRIC_COUNTER::BUSY_SENT);
+            serverContext.closeConnection(index, true);
         }
+    }
+}
 
+bool ServerCroupier::writeQueuedToPlayer(int index) {
+    do {
         std::string message = serverContext.getFirstWriteMessageAt(index);
-        ssize_t sentLen = serverContext.sendMessageServer(index, message);
+        // Loop keeps sending until queue is empty, so the last message clears the cork.
+        ssize_t sentLen = serverContext.sendMessageServer(index, message, true);
         if (sentLen <= 0) {
             if (sentLen < 0 and (errno == EAGAIN or errno == EWOULDBLOCK)) {
-                continue;
+                return false;
             }
 
             if (serverStatus.gameEnded) {
@@ -503,43 +867,219 @@ void ServerCroupier::writeToPlayers() {
             }
 
             closeConnectionWithPlayer(index);
-            continue;
+            return false;
         }
 
         std::string currentMessage = serverContext.getCurrentWriteMessageAt(index);
 
         if (not serverContext.wroteWholeMessageAt(index, sentLen)) {
-            continue;
+            return false;
         }
 
         serverContext.displayMessageFromServer(index, currentMessage);
         serverContext.checkIfEmpty(index);
+    } while (serverContext.corksWrites() and serverContext.hasPendingWriteAt(index));
+
+    return not serverContext.hasPendingWriteAt(index);
+}
+
+void ServerCroupier::writeToPlayers() {
+    if (not serverStatus.pollIncludesPlayers()) {
+        return;
+    }
 
-        if (canBeWrong(currentMessage)) {
+    for (int index : serverContext.getReadyToWrite()) {
+        if (index >= ServerConstants::ACCEPT_INDEX) {
+            break; // Ready connections are sorted, so there are no more players.
+        }
+        if (not serverContext.pollWriteAt(index) or not writeQueuedToPlayer(index)) {
             continue;
         }
 
+        // Player received everything queued for it.
         if (serverContext.getClientStateAt(index) == CLIENT_STATE::SENDING_PREVIOUS) {
             afterSendingPrevious(index);
-        } else if (canBeDeal(currentMessage)) {
-            afterSendingDeal(index);
-        } else if (canBeTrick(currentMessage)) {
-            afterSendingTrick(index);
-        } else if (canBeTaken(currentMessage)) {
-            afterSendingTaken(index);
-        } else if (canBeScore(currentMessage)) {
-            afterSendingScore(index);
-        } else if (canBeTotal(currentMessage)) {
-            afterSendingTotal(index);
         }
+        tableWait.resume(FLOW_WAIT::SENT, index, SEAT_EVENT::DONE);
+    }
+}
+
+void ServerCroupier::serialize(StateWriter &stateWriter) {
+    writeServerStatus(stateWriter, serverStatus);
+    serverContext.serialize(stateWriter);
+    writeServerLobby(stateWriter, lobby);
+    spectatorFeed.serialize(stateWriter);
+
+    for (auto sentAt : trickSentAt) {
+        stateWriter.writeInt(sentAt.time_since_epoch().count());
+    }
+    stateWriter.writeInt(currentGame);
+    stateWriter.writeInt(trickPublished);
+
+    for (bool botSeat : botSeats) {
+        stateWriter.writeInt(botSeat);
+    }
+    stateWriter.writeInt(vacantSince.size());
+    for (auto &[seat, since] : vacantSince) {
+        stateWriter.writeInt(seat);
+        stateWriter.writeInt(since.time_since_epoch().count());
+    }
+
+    report.serialize(stateWriter);
+}
+
+void ServerCroupier::deserialize(StateReader &stateReader) {
+    readServerStatus(stateReader, serverStatus);
+    serverContext.deserialize(stateReader);
+    readServerLobby(stateReader, lobby);
+    spectatorFeed.deserialize(stateReader);
+
+    // Steady clock is shared by processes on the same machine.
+    for (auto &sentAt : trickSentAt) {
+        sentAt = std::chrono::steady_clock::time_point(
+            std::chrono::steady_clock::duration(stateReader.readInt()));
+    }
+
+    // New process is started with the same files.
+    currentGame = stateReader.readInt() % games.size();
+    trickPublished = stateReader.readInt() != 0;
+
+    for (bool &botSeat : botSeats) {
+        botSeat = stateReader.readInt() != 0;
+    }
+    vacantSince.clear();
+    int64_t vacant = stateReader.readInt();
+    for (int64_t i = 0; i < vacant and not stateReader.hasFailed(); i++) {
+        int seat = (int)stateReader.readInt();
+        vacantSince[seat] = std::chrono::steady_clock::time_point(
+            std::chrono::steady_clock::duration(stateReader.readInt()));
+    }
+
+    report.deserialize(stateReader);
+}
+
+std::chrono::steady_clock::time_point ServerCroupier::takeOverGame(int upgradeFd) {
+    std::string state;
+    std::vector<int> fds;
+    if (not receiveState(upgradeFd, state, fds)) {
+        fatal("cannot receive game from running server");
+    }
+
+    StateReader stateReader(state, fds);
+    auto stoppedAt = std::chrono::steady_clock::time_point(
+        std::chrono::steady_clock::duration(stateReader.readInt()));
+    deserialize(stateReader);
+
+    if (stateReader.hasFailed()) {
+        fatal("malformed game received from running server");
     }
+
+    return stoppedAt;
 }
 
-ServerCroupier::ServerCroupier(int socketFd, ServerArguments &serverArguments,
-                               ServerStatus &serverStatus)
-    : serverStatus(serverStatus) {
+void ServerCroupier::handleUpgrade() {
+    if (not serverContext.pollReadAt(ServerConstants::UPGRADE_INDEX)) {
+        return;
+    }
+
+    int upgradeFd = accept4(serverContext.getPollDescriptor(ServerConstants::UPGRADE_INDEX),
+                            nullptr, nullptr, SOCK_CLOEXEC);
+    if (upgradeFd < 0) {
+        if (errno != EAGAIN and errno != EWOULDBLOCK and errno != EINTR) {
+            sysError("accept");
+        }
+        return;
+    }
+    if (not setHandoverTimeout(upgradeFd)) {
+        sysError("cannot set timeout of upgrade socket");
+        close(upgradeFd);
+        return;
+    }
+
+    // Game stands still from now on, until new process confirms it took it over.
+    StateWriter stateWriter;
+    stateWriter.writeInt(std::chrono::steady_clock::now().time_since_epoch().count());
+    serialize(stateWriter);
+
+    // If new process fails or does not confirm in time, we keep serving the game. Our reply to
+    // its confirmation tells it that we did not give up waiting, so only one of us serves.
+    if (sendState(upgradeFd, stateWriter) and receiveAck(upgradeFd) and sendAck(upgradeFd)) {
+        handedOver = true;
+    } else {
+        error("upgrade failed, server keeps running");
+    }
+
+    close(upgradeFd);
+}
+
+ServerCroupier::ServerCroupier(int socketFd, int unixSocketFd, int metricsFd, int upgradeFd,
+                               ServerArguments &serverArguments,
+                               std::vector<ServerStatus> &games)
+    : serverStatus(games.front()), daemonEnabled(serverArguments.daemonEnabled), games(games),
+      lobbyEnabled(serverArguments.lobbyEnabled),
+      spectatorsEnabled(serverArguments.spectatorsEnabled),
+      journalPath(serverArguments.journalStr), upgradePath(serverArguments.upgradeStr),
+      botGrace(serverArguments.botGrace < 0 ? Constants::ERROR_CODE
+                                            : serverArguments.botGrace * 1000) {
     int baseTimeout = serverArguments.timeout * 1000;
-    serverContext.createContext(baseTimeout, socketFd);
+    serverContext.createContext(baseTimeout, socketFd, unixSocketFd, metricsFd);
+    serverContext.setConnectionLimits(serverArguments.readLimit, serverArguments.writeLimit);
+    serverContext.setSocketOptions(serverArguments.socketOptions);
+    report.openReport(serverArguments.reportStr);
+
+    std::chrono::steady_clock::time_point stoppedAt;
+    if (upgradeFd >= 0) {
+        stoppedAt = takeOverGame(upgradeFd);
+    }
+
+    // Daemon recovers the game its journal was written for.
+    if (upgradeFd < 0 and journalPath != nullptr) {
+        for (size_t game = 0; game < this->games.size(); game++) {
+            if (ServerJournal::isJournalOf(journalPath, this->games[game])) {
+                currentGame = game;
+                this->serverStatus = this->games[game];
+                break;
+            }
+        }
+    }
+
+    // Recovered game continues once all players rejoin, like after a disconnection.
+    journal.openJournal(journalPath, this->serverStatus, upgradeFd < 0);
+    if (upgradeFd < 0 and this->serverStatus.gameStarted) {
+        publishDeals();
+        spectatorFeed.appendEvent(this->serverStatus.getPreviousTaken(), serverContext);
+        report.startGame();
+    }
+    if (this->serverStatus.gameStarted and not this->serverStatus.gameEnded) {
+        metricsAddGauge(METRIC_GAUGE::ACTIVE_TABLES, 1);
+    }
+
+    // Grace period of players of recovered game starts now.
+    if (upgradeFd < 0 and botGrace >= 0 and this->serverStatus.gameStarted and
+        not this->serverStatus.gameEnded) {
+        for (int seat = 0; seat < Constants::PLAYERS_NUMBER; seat++) {
+            vacantSince[seat] = std::chrono::steady_clock::now();
+        }
+    }
+
+    metricsEndpoint.createEndpoint(serverContext);
+    if (upgradePath != nullptr) {
+        serverContext.setPollDescriptor(ServerConstants::UPGRADE_INDEX,
+                                        createUpgradeSocket(upgradePath), POLLIN);
+    }
+
+    if (upgradeFd >= 0) {
+        if (not sendAck(upgradeFd) or not receiveAck(upgradeFd)) {
+            fatal("running server did not wait for confirmation");
+        }
+        close(upgradeFd);
+
+        std::cerr << "Took over game, it was paused for " << microsSince(stoppedAt) << " us"
+                  << std::endl;
+    }
+
+    tableFlow = playTable();
+    tableFlow.start();
 }
 
 void ServerCroupier::handleGame() {
@@ -547,7 +1087,8 @@ void ServerCroupier::handleGame() {
 
     do {
         // Executing Poll.
-        int pollStatus = serverContext.executePoll(serverStatus.pollIncludesPlayers());
+        int pollStatus =
+            serverContext.executePoll(serverStatus.pollIncludesPlayers(), getBotTimeout());
 
         if (pollStatus == Constants::ERROR_CODE) {
             if (errno != EINTR) {
@@ -557,8 +1098,12 @@ void ServerCroupier::handleGame() {
             continue;
         }
 
+        auto iterationStart = std::chrono::steady_clock::now();
+
         if (pollStatus == 0) {
             handleTimeout();
+            handleVacantSeats();
+            metricsObserve(METRIC_HISTOGRAM::LOOP_ITERATION_TIME, microsSince(iterationStart));
             continue;
         }
 
@@ -574,15 +1119,41 @@ void ServerCroupier::handleGame() {
         // Handle players' buffer.
         handlePlayersBuffer();
 
+        // Server plays seats of players who did not come back in time.
+        handleVacantSeats();
+
+        // Close clients who do not read what is queued for them.
+        evictOverWriteLimit();
+
+        // Accepted cards reach disk before anyone is told about them.
+        journal.commit();
+
         // Write to non players.
         writeToNonPlayers();
 
         // Write to players.
         writeToPlayers();
+
+        // Serve metrics.
+        metricsEndpoint.handleEndpoint(serverContext);
+
+        // Hand game over to new server process.
+        handleUpgrade();
+        if (handedOver) {
+            break;
+        }
+
+        // Daemon starts next game as soon as table empties.
+        if (daemonEnabled and serverStatus.hasEveryoneLeft()) {
+            startNextGame();
+        }
+
+        metricsObserve(METRIC_HISTOGRAM::LOOP_ITERATION_TIME, microsSince(iterationStart));
     } while (not serverStatus.hasEveryoneLeft());
 
-    // Server closes connections.
-    for (int i = 0; i < ServerConstants::CONNECTIONS; i++) {
+    // Server closes connections. After upgrade only our copies of descriptors are closed, new
+    // process keeps connections open.
+    for (int i = 0; i < serverContext.getSlotsNumber(); i++) {
         serverContext.closeDescriptor(i);
     }
 }
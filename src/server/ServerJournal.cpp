@@ -0,0 +1,270 @@
+#include "server/ServerJournal.h"
+
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "server/StateSerializer.h"
+#include "err/err.h"
+
+/// @brief Returns card encoded on a single byte.
+static uint8_t encodeCard(Card card) {
+    return static_cast<uint8_t>((static_cast<int>(card.cardColor) << 4) | card.cardValue);
+}
+
+/// @brief Returns card decoded from a single byte.
+static Card decodeCard(uint8_t byte) {
+    Card card = Card();
+    card.cardColor = static_cast<CARD_COLOR>(byte >> 4);
+    card.cardValue = byte & 0x0f;
+    return card;
+}
+
+/// @brief Returns whole content of file or empty string if it does not exist.
+static std::string readFile(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+/// @brief Writes whole buffer to descriptor.
+static bool writeAll(int fd, const std::string &buffer) {
+    size_t written = 0;
+    while (written < buffer.size()) {
+        ssize_t writeLen = write(fd, buffer.data() + written, buffer.size() - written);
+        if (writeLen < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        written += writeLen;
+    }
+    return true;
+}
+
+uint64_t ServerJournal::getFingerprint(ServerStatus &serverStatus) {
+    // FNV-1a over all deal messages.
+    uint64_t hash = 14695981039346656037ULL;
+    for (auto &hand : serverStatus.hands) {
+        for (auto &[place, dealStr] : hand.dealStrAtPlace) {
+            for (char c : dealStr) {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= 1099511628211ULL;
+            }
+        }
+    }
+    return hash;
+}
+
+bool ServerJournal::readSnapshot(ServerStatus &serverStatus) {
+    std::string snapshot = readFile(snapshotPath);
+    if (snapshot.size() != JournalConstants::SNAPSHOT_SIZE or
+        readBytes(snapshot.data(), 4) != JournalConstants::SNAPSHOT_MAGIC or
+        readBytes(snapshot.data() + 4, 8) != fingerprint) {
+        return false;
+    }
+
+    int currentHand = (int)readBytes(snapshot.data() + 12, 4);
+    if (currentHand >= (int)serverStatus.hands.size()) {
+        return false;
+    }
+
+    serverStatus.currentHand = currentHand;
+    serverStatus.gameStarted = currentHand > 0;
+    for (int i = 0; i < Constants::PLAYERS_NUMBER; i++) {
+        serverStatus.playerTotalScores[static_cast<TABLE_PLACE>(i)] =
+            readBytes(snapshot.data() + 16 + 8 * i, 8);
+    }
+
+    return true;
+}
+
+bool ServerJournal::replayCard(ServerStatus &serverStatus, TABLE_PLACE place, Card card) {
+    // Same transitions as in ServerCroupier::afterReceivingTrick, without sending anything.
+    if (static_cast<int>(place) != serverStatus.getCurrentTablePlace() or
+        not serverStatus.playerPlacesCard(place, card)) {
+        return false;
+    }
+
+    auto nextClient = static_cast<TABLE_PLACE>((static_cast<int>(place) + 1) %
+                                               Constants::PLAYERS_NUMBER);
+    serverStatus.setCurrentTablePlace(nextClient);
+    if (serverStatus.getPreviousTrickTaker() != nextClient) {
+        return true;
+    }
+
+    serverStatus.takeTrick();
+    serverStatus.finishTrick();
+    if (not serverStatus.hasHandEnded()) {
+        return true;
+    }
+
+    for (int i = 0; i < Constants::PLAYERS_NUMBER; i++) {
+        serverStatus.updatePlayerTotalScore(i);
+    }
+    serverStatus.finishHand();
+
+    return true;
+}
+
+void ServerJournal::replayLog(ServerStatus &serverStatus) {
+    std::string log = readFile(logPath);
+    if (log.size() < JournalConstants::HEADER_SIZE or readBytes(log.data(), 8) != fingerprint) {
+        return;
+    }
+
+    // Torn record at the end of log is ignored.
+    for (size_t offset = JournalConstants::HEADER_SIZE;
+         offset + JournalConstants::RECORD_SIZE <= log.size();
+         offset += JournalConstants::RECORD_SIZE) {
+        int hand = (int)readBytes(log.data() + offset, 2);
+        auto place = static_cast<TABLE_PLACE>(log[offset + 2] % Constants::PLAYERS_NUMBER);
+        Card card = decodeCard(static_cast<uint8_t>(log[offset + 3]));
+
+        // Records of hand already covered by snapshot.
+        if (hand < serverStatus.currentHand) {
+            continue;
+        }
+
+        if (serverStatus.gameEnded or hand != serverStatus.currentHand or
+            not replayCard(serverStatus, place, card)) {
+            error("journal %s is inconsistent, stopped replaying it", logPath.c_str());
+            return;
+        }
+
+        serverStatus.gameStarted = true;
+
+        // Records of current hand are kept, so they can be written to truncated log again.
+        if (hand == serverStatus.currentHand) {
+            pending.append(log, offset, JournalConstants::RECORD_SIZE);
+        } else {
+            pending.clear();
+        }
+    }
+}
+
+void ServerJournal::resetLog() {
+    if (ftruncate(logFd, 0) < 0) {
+        sysError("ftruncate");
+    }
+
+    std::string header;
+    appendBytes(header, fingerprint, 8);
+    if (not writeAll(logFd, header) or fdatasync(logFd) < 0) {
+        sysError("write journal");
+    }
+}
+
+bool ServerJournal::isJournalOf(const char *path, ServerStatus &serverStatus) {
+    std::string log = readFile(path);
+    return log.size() >= JournalConstants::HEADER_SIZE and
+           readBytes(log.data(), 8) == getFingerprint(serverStatus);
+}
+
+void ServerJournal::openJournal(const char *path, ServerStatus &serverStatus, bool recover) {
+    if (path == nullptr) {
+        return;
+    }
+
+    enabled = true;
+    logPath = path;
+    snapshotPath = logPath + JournalConstants::SNAPSHOT_SUFFIX;
+    fingerprint = getFingerprint(serverStatus);
+
+    // Status handed over by previous process is already up to date with journal, we only
+    // continue appending to it.
+    if (not recover) {
+        logFd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (logFd < 0) {
+            sysFatal("cannot open journal %s", path);
+        }
+        if (lseek(logFd, 0, SEEK_END) == 0) {
+            writeSnapshot(serverStatus);
+        }
+        return;
+    }
+
+    ServerStatus recovered = serverStatus;
+    readSnapshot(recovered);
+    replayLog(recovered);
+
+    // Server crashed before it removed journal of finished game, so we start a new one.
+    if (recovered.gameEnded) {
+        pending.clear();
+    } else {
+        serverStatus = recovered;
+    }
+
+    logFd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (logFd < 0) {
+        sysFatal("cannot open journal %s", path);
+    }
+
+    // Log is rewritten with replayed records of current hand only, dropping torn tail.
+    std::string records = pending;
+    writeSnapshot(serverStatus);
+    pending = records;
+    commit();
+}
+
+void ServerJournal::logCard(int currentHand, TABLE_PLACE place, Card card) {
+    if (not enabled) {
+        return;
+    }
+
+    appendBytes(pending, currentHand, 2);
+    pending.push_back(static_cast<char>(place));
+    pending.push_back(static_cast<char>(encodeCard(card)));
+}
+
+void ServerJournal::commit() {
+    if (not enabled or pending.empty()) {
+        return;
+    }
+
+    if (not writeAll(logFd, pending) or fdatasync(logFd) < 0) {
+        sysError("write journal");
+    }
+    pending.clear();
+}
+
+void ServerJournal::writeSnapshot(ServerStatus &serverStatus) {
+    if (not enabled) {
+        return;
+    }
+
+    std::string snapshot;
+    appendBytes(snapshot, JournalConstants::SNAPSHOT_MAGIC, 4);
+    appendBytes(snapshot, fingerprint, 8);
+    appendBytes(snapshot, serverStatus.currentHand, 4);
+    for (int i = 0; i < Constants::PLAYERS_NUMBER; i++) {
+        appendBytes(snapshot, serverStatus.playerTotalScores[static_cast<TABLE_PLACE>(i)], 8);
+    }
+
+    // Snapshot is replaced atomically, so a crash leaves either old or new one.
+    std::string temporaryPath = snapshotPath + JournalConstants::TEMPORARY_SUFFIX;
+    int snapshotFd = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (snapshotFd < 0 or not writeAll(snapshotFd, snapshot) or fsync(snapshotFd) < 0 or
+        rename(temporaryPath.c_str(), snapshotPath.c_str()) < 0) {
+        sysError("write snapshot %s", snapshotPath.c_str());
+    }
+    if (snapshotFd >= 0) {
+        close(snapshotFd);
+    }
+
+    pending.clear();
+    resetLog();
+}
+
+void ServerJournal::finish() {
+    if (not enabled) {
+        return;
+    }
+
+    close(logFd);
+    unlink(logPath.c_str());
+    unlink(snapshotPath.c_str());
+    enabled = false;
+}
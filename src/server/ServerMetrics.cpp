@@ -0,0 +1,293 @@
+#include "server/ServerMetrics.h"
+
+#include <mutex>
+
+#include "server/ServerContext.h"
+
+/// METRICS REGISTRY ///
+
+struct CounterInfo {
+    const char *name;
+    const char *help;
+};
+
+struct HistogramInfo {
+    const char *name;
+    const char *help;
+    std::vector<uint64_t> boundsMicros;
+};
+
+static const CounterInfo COUNTER_INFO[] = {
+    {"kierki_connections_accepted_total", "Connections accepted by the server."},
+    {"kierki_busy_sent_total", "BUSY messages sent to clients."},
+    {"kierki_iam_timeouts_total", "Clients disconnected for not sending IAM in time."},
+    {"kierki_trick_timeouts_total", "Players that did not send TRICK in time."},
+    {"kierki_wrong_sent_total", "WRONG messages sent to clients."},
+    {"kierki_bytes_in_total", "Bytes read from game connections."},
+    {"kierki_bytes_out_total", "Bytes written to game connections."},
+    {"kierki_limit_evictions_total", "Connections closed for buffering more than byte limit."},
+    {"kierki_shm_connections_total", "Connections moved to shared memory transport."},
+    {"kierki_games_played_total", "Games played until the end."},
+    {"kierki_bot_substitutions_total", "Seats taken over by server after grace period."},
+    {"kierki_bot_cards_total", "Cards placed by server for disconnected players."},
+};
+
+static const CounterInfo GAUGE_INFO[] = {
+    {"kierki_active_tables", "Tables with a game in progress."},
+    {"kierki_connection_table_bytes", "Bytes allocated for connection slots."},
+};
+
+static const HistogramInfo HISTOGRAM_INFO[] = {
+    {"kierki_player_think_time_seconds",
+     "Time between TRICK sent to a player and a valid card received.",
+     {1000, 5000, 10000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000,
+      30000000}},
+    {"kierki_event_loop_iteration_seconds",
+     "Time spent handling events after a single poll wakeup.",
+     {1, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000}},
+    {"kierki_game_restart_seconds", "Time daemon spent setting up next game after table emptied.",
+     {1, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000}},
+};
+
+static std::mutex shardsMutex;
+static std::vector<MetricsShard *> shards;
+
+/// @brief Returns metrics shard of calling thread, registering it on first use.
+static MetricsShard &localShard() {
+    static thread_local MetricsShard *shard = nullptr;
+    if (shard == nullptr) {
+        shard = new MetricsShard();
+
+        std::lock_guard<std::mutex> lock(shardsMutex);
+        shards.emplace_back(shard);
+    }
+    return *shard;
+}
+
+void metricsIncrement(METRIC_COUNTER counter, uint64_t value) {
+    localShard().counters[static_cast<int>(counter)].fetch_add(value, std::memory_order_relaxed);
+}
+
+void metricsAddGauge(METRIC_GAUGE gauge, int64_t delta) {
+    localShard().gauges[static_cast<int>(gauge)].fetch_add(delta, std::memory_order_relaxed);
+}
+
+void metricsObserve(METRIC_HISTOGRAM histogram, uint64_t micros) {
+    int histogramInt = static_cast<int>(histogram);
+    const std::vector<uint64_t> &bounds = HISTOGRAM_INFO[histogramInt].boundsMicros;
+
+    size_t bucket = 0;
+    while (bucket < bounds.size() and micros > bounds[bucket]) {
+        bucket++;
+    }
+
+    MetricsShard &shard = localShard();
+    shard.buckets[histogramInt][bucket].fetch_add(1, std::memory_order_relaxed);
+    shard.histogramSums[histogramInt].fetch_add(micros, std::memory_order_relaxed);
+    shard.histogramCounts[histogramInt].fetch_add(1, std::memory_order_relaxed);
+}
+
+/// @brief Returns microseconds formatted as seconds.
+static std::string microsToSeconds(uint64_t micros) {
+    std::stringstream ss;
+    ss << micros / 1000000 << '.' << std::setfill('0') << std::setw(6) << micros % 1000000;
+    return ss.str();
+}
+
+std::string getMetricsText() {
+    std::lock_guard<std::mutex> lock(shardsMutex);
+    std::stringstream ss;
+
+    for (int i = 0; i < static_cast<int>(METRIC_COUNTER::COUNT); i++) {
+        uint64_t value = 0;
+        for (auto shard : shards) {
+            value += shard->counters[i].load(std::memory_order_relaxed);
+        }
+
+        ss << "# HELP " << COUNTER_INFO[i].name << ' ' << COUNTER_INFO[i].help << '\n';
+        ss << "# TYPE " << COUNTER_INFO[i].name << " counter\n";
+        ss << COUNTER_INFO[i].name << ' ' << value << '\n';
+    }
+
+    for (int i = 0; i < static_cast<int>(METRIC_GAUGE::COUNT); i++) {
+        int64_t value = 0;
+        for (auto shard : shards) {
+            value += shard->gauges[i].load(std::memory_order_relaxed);
+        }
+
+        ss << "# HELP " << GAUGE_INFO[i].name << ' ' << GAUGE_INFO[i].help << '\n';
+        ss << "# TYPE " << GAUGE_INFO[i].name << " gauge\n";
+        ss << GAUGE_INFO[i].name << ' ' << value << '\n';
+    }
+
+    for (int i = 0; i < static_cast<int>(METRIC_HISTOGRAM::COUNT); i++) {
+        const HistogramInfo &info = HISTOGRAM_INFO[i];
+        ss << "# HELP " << info.name << ' ' << info.help << '\n';
+        ss << "# TYPE " << info.name << " histogram\n";
+
+        uint64_t cumulative = 0, sum = 0, count = 0;
+        for (size_t bucket = 0; bucket <= info.boundsMicros.size(); bucket++) {
+            for (auto shard : shards) {
+                cumulative += shard->buckets[i][bucket].load(std::memory_order_relaxed);
+            }
+
+            ss << info.name << "_bucket{le=\"";
+            if (bucket < info.boundsMicros.size()) {
+                ss << microsToSeconds(info.boundsMicros[bucket]);
+            } else {
+                ss << "+Inf";
+            }
+            ss << "\"} " << cumulative << '\n';
+        }
+
+        for (auto shard : shards) {
+            sum += shard->histogramSums[i].load(std::memory_order_relaxed);
+            count += shard->histogramCounts[i].load(std::memory_order_relaxed);
+        }
+
+        ss << info.name << "_sum " << microsToSeconds(sum) << '\n';
+        ss << info.name << "_count " << count << '\n';
+    }
+
+    return ss.str();
+}
+
+/// METRICS ENDPOINT ///
+
+int MetricsEndpoint::slotOf(int index) {
+    return index - ServerConstants::METRICS_INDEX - 1;
+}
+
+void MetricsEndpoint::createEndpoint(ServerContext &serverContext) {
+    enabled = serverContext.isDescriptorReserved(ServerConstants::METRICS_INDEX);
+
+    requests.resize(ServerConstants::METRICS_CONNECTIONS);
+    responses.resize(ServerConstants::METRICS_CONNECTIONS);
+    responseOffsets.resize(ServerConstants::METRICS_CONNECTIONS, 0);
+    acceptOrder.resize(ServerConstants::METRICS_CONNECTIONS, 0);
+}
+
+void MetricsEndpoint::closeHttpConnection(int index, ServerContext &serverContext) {
+    serverContext.closeDescriptor(index);
+    serverContext.resetPollDescriptor(index);
+
+    int slot = slotOf(index);
+    requests[slot].clear();
+    responses[slot].clear();
+    responseOffsets[slot] = 0;
+}
+
+int MetricsEndpoint::takeSlot(ServerContext &serverContext) {
+    int oldest = ServerConstants::METRICS_INDEX + 1;
+    for (int index = ServerConstants::METRICS_INDEX + 1; index < ServerConstants::METRICS_END;
+         index++) {
+        if (not serverContext.isDescriptorReserved(index)) {
+            return index;
+        }
+        if (acceptOrder[slotOf(index)] < acceptOrder[slotOf(oldest)]) {
+            oldest = index;
+        }
+    }
+
+    // Clients that connect and send nothing would otherwise hold every slot and block scraping.
+    closeHttpConnection(oldest, serverContext);
+    return oldest;
+}
+
+void MetricsEndpoint::acceptHttpConnections(ServerContext &serverContext) {
+    if (not serverContext.pollReadAt(ServerConstants::METRICS_INDEX)) {
+        return;
+    }
+
+    int clientFd;
+    while ((clientFd = accept4(serverContext.getPollDescriptor(ServerConstants::METRICS_INDEX),
+                               nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        int placeInPoll = takeSlot(serverContext);
+        acceptOrder[slotOf(placeInPoll)] = ++acceptedCount;
+        serverContext.setPollDescriptor(placeInPoll, clientFd, POLLIN);
+    }
+
+    if (errno != EAGAIN and errno != EWOULDBLOCK) {
+        sysError("accept");
+    }
+}
+
+void MetricsEndpoint::readRequest(int index, ServerContext &serverContext) {
+    static char buffer[ServerConstants::BUFFER_SIZE];
+
+    ssize_t readLen = read(serverContext.getPollDescriptor(index), buffer, sizeof(buffer));
+    if (readLen <= 0) {
+        closeHttpConnection(index, serverContext);
+        return;
+    }
+
+    int slot = slotOf(index);
+    std::string &request = requests[slot];
+    request.append(buffer, readLen);
+
+    if (request.find(MetricsConstants::HTTP_END_OF_HEADERS) == std::string::npos) {
+        if (request.size() > MetricsConstants::MAX_REQUEST_SIZE) {
+            closeHttpConnection(index, serverContext);
+        }
+        return;
+    }
+
+    std::string status = "200 OK", body;
+    if (prefixEqual(request, "GET " + MetricsConstants::METRICS_PATH + " ") or
+        prefixEqual(request, "GET / ")) {
+        body = getMetricsText();
+    } else {
+        status = "404 Not Found";
+        body = "Not Found\n";
+    }
+
+    std::stringstream ss;
+    ss << "HTTP/1.0 " << status << "\r\n"
+       << "Content-Type: text/plain; version=0.0.4\r\n"
+       << "Content-Length: " << body.size() << "\r\n"
+       << "Connection: close\r\n\r\n"
+       << body;
+
+    responses[slot] = ss.str();
+    responseOffsets[slot] = 0;
+    serverContext.setPollEvents(index, POLLOUT);
+}
+
+void MetricsEndpoint::writeResponse(int index, ServerContext &serverContext) {
+    int slot = slotOf(index);
+    const std::string &response = responses[slot];
+
+    ssize_t sentLen = sendMessage(serverContext.getPollDescriptor(index),
+                                  response.data() + responseOffsets[slot],
+                                  response.size() - responseOffsets[slot]);
+    if (sentLen < 0 and (errno == EAGAIN or errno == EWOULDBLOCK)) {
+        return;
+    }
+
+    if (sentLen <= 0) {
+        closeHttpConnection(index, serverContext);
+        return;
+    }
+
+    responseOffsets[slot] += sentLen;
+    if (responseOffsets[slot] == response.size()) {
+        closeHttpConnection(index, serverContext);
+    }
+}
+
+void MetricsEndpoint::handleEndpoint(ServerContext &serverContext) {
+    if (not enabled) {
+        return;
+    }
+
+    acceptHttpConnections(serverContext);
+
+    for (int index = ServerConstants::METRICS_INDEX + 1; index < ServerConstants::METRICS_END;
+         index++) {
+        if (serverContext.pollReadAt(index)) {
+            readRequest(index, serverContext);
+        } else if (serverContext.pollWriteAt(index)) {
+            writeResponse(index, serverContext);
+        }
+    }
+}
@@ -0,0 +1,314 @@
+#include "server/ServerUpgrade.h"
+
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "err/err.h"
+
+/// SERIALIZING GAME STATE ///
+
+/// @brief Writes map of strings at table places.
+static void writeStrMap(StateWriter &stateWriter, const std::map<TABLE_PLACE, std::string> &map) {
+    stateWriter.writeInt(map.size());
+    for (const auto &[place, str] : map) {
+        stateWriter.writeInt(static_cast<int>(place));
+        stateWriter.writeString(str);
+    }
+}
+
+/// @brief Reads map of strings at table places.
+static void readStrMap(StateReader &stateReader, std::map<TABLE_PLACE, std::string> &map) {
+    map.clear();
+    int64_t size = stateReader.readInt();
+    for (int64_t i = 0; i < size and not stateReader.hasFailed(); i++) {
+        auto place = static_cast<TABLE_PLACE>(stateReader.readInt());
+        map[place] = stateReader.readString();
+    }
+}
+
+static void writeServerHand(StateWriter &stateWriter, ServerHand &hand) {
+    stateWriter.writeInt(static_cast<int>(hand.handType));
+    stateWriter.writeInt(static_cast<int>(hand.previousTrickTaker));
+    stateWriter.writeInt(static_cast<int>(hand.currentClient));
+    stateWriter.writeInt(hand.currentTrick);
+    stateWriter.writeCards(hand.currentlyPlacedCards);
+
+    writeStrMap(stateWriter, hand.dealStrAtPlace);
+    writeStrMap(stateWriter, hand.dealBinaryAtPlace);
+    stateWriter.writeString(hand.previousTaken);
+    stateWriter.writeString(hand.previousTakenBinary);
+
+    for (uint64_t cardsMask : hand.playerCards) {
+        stateWriter.writeInt(static_cast<int64_t>(cardsMask));
+    }
+    stateWriter.writePlaceMap(hand.playerScores);
+}
+
+static void readServerHand(StateReader &stateReader, ServerHand &hand) {
+    hand.handType = static_cast<HAND_TYPE>(stateReader.readInt());
+    hand.previousTrickTaker = static_cast<TABLE_PLACE>(stateReader.readInt());
+    hand.currentClient = static_cast<TABLE_PLACE>(stateReader.readInt());
+    hand.currentTrick = (int)stateReader.readInt();
+    hand.currentlyPlacedCards = stateReader.readCards();
+
+    readStrMap(stateReader, hand.dealStrAtPlace);
+    readStrMap(stateReader, hand.dealBinaryAtPlace);
+    hand.previousTaken = stateReader.readString();
+    hand.previousTakenBinary = stateReader.readString();
+
+    for (uint64_t &cardsMask : hand.playerCards) {
+        cardsMask = static_cast<uint64_t>(stateReader.readInt());
+    }
+    stateReader.readPlaceMap(hand.playerScores);
+}
+
+void writeServerStatus(StateWriter &stateWriter, ServerStatus &serverStatus) {
+    stateWriter.writeInt(serverStatus.activePlayers);
+    stateWriter.writeInt(serverStatus.currentHand);
+
+    stateWriter.writeInt(serverStatus.hands.size());
+    for (auto &hand : serverStatus.hands) {
+        writeServerHand(stateWriter, hand);
+    }
+
+    stateWriter.writePlaceMap(serverStatus.playerTotalScores);
+    stateWriter.writePlaceMap(serverStatus.dealSend);
+    stateWriter.writePlaceMap(serverStatus.alreadyLeft);
+
+    stateWriter.writeInt(serverStatus.gameStarted);
+    stateWriter.writeInt(serverStatus.gameEnded);
+}
+
+void readServerStatus(StateReader &stateReader, ServerStatus &serverStatus) {
+    serverStatus.activePlayers = (int)stateReader.readInt();
+    serverStatus.currentHand = (int)stateReader.readInt();
+
+    serverStatus.hands.clear();
+    int64_t size = stateReader.readInt();
+    for (int64_t i = 0; i < size and not stateReader.hasFailed(); i++) {
+        ServerHand hand = ServerHand();
+        readServerHand(stateReader, hand);
+        serverStatus.hands.emplace_back(hand);
+    }
+
+    stateReader.readPlaceMap(serverStatus.playerTotalScores);
+    stateReader.readPlaceMap(serverStatus.dealSend);
+    stateReader.readPlaceMap(serverStatus.alreadyLeft);
+
+    serverStatus.gameStarted = stateReader.readInt() != 0;
+    serverStatus.gameEnded = stateReader.readInt() != 0;
+}
+
+void writeServerLobby(StateWriter &stateWriter, ServerLobby &lobby) {
+    stateWriter.writeInt(lobby.waitingAt.size());
+    for (const auto &[place, queue] : lobby.waitingAt) {
+        stateWriter.writeInt(static_cast<int>(place));
+        stateWriter.writeInt(queue.size());
+        for (int index : queue) {
+            stateWriter.writeInt(index);
+        }
+    }
+}
+
+void readServerLobby(StateReader &stateReader, ServerLobby &lobby) {
+    lobby.waitingAt.clear();
+    int64_t places = stateReader.readInt();
+    for (int64_t i = 0; i < places and not stateReader.hasFailed(); i++) {
+        auto place = static_cast<TABLE_PLACE>(stateReader.readInt());
+        int64_t size = stateReader.readInt();
+        for (int64_t j = 0; j < size and not stateReader.hasFailed(); j++) {
+            lobby.waitingAt[place].push_back((int)stateReader.readInt());
+        }
+    }
+}
+
+/// HANDING OVER STATE ///
+
+/// @brief Writes whole buffer to socket.
+static bool sendAll(int fd, const char *data, size_t len) {
+    size_t sent = 0;
+    while (sent < len) {
+        ssize_t sentLen = send(fd, data + sent, len - sent, MSG_NOSIGNAL);
+        if (sentLen < 0 and errno == EINTR) {
+            continue;
+        }
+        if (sentLen <= 0) {
+            return false;
+        }
+        sent += sentLen;
+    }
+    return true;
+}
+
+/// @brief Reads exactly len bytes from socket.
+static bool receiveAll(int fd, char *data, size_t len) {
+    size_t received = 0;
+    while (received < len) {
+        ssize_t readLen = read(fd, data + received, len - received);
+        if (readLen < 0 and errno == EINTR) {
+            continue;
+        }
+        if (readLen <= 0) {
+            return false;
+        }
+        received += readLen;
+    }
+    return true;
+}
+
+int createUpgradeSocket(const char *path) {
+    sockaddr_un address;
+    socklen_t addressLen;
+    if (not setUnixAddress(address, addressLen, path)) {
+        fatal("upgrade socket path %s is too long", path);
+    }
+
+    int upgradeFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (upgradeFd < 0) {
+        sysFatal("cannot create a socket");
+    }
+
+    if (path[0] != SocketConstants::ABSTRACT_PREFIX) {
+        unlink(path);
+    }
+    if (bind(upgradeFd, (sockaddr *)&address, addressLen) < 0) {
+        sysFatal("bind %s", path);
+    }
+
+    if (listen(upgradeFd, 1) < 0) {
+        sysFatal("listen");
+    }
+
+    return upgradeFd;
+}
+
+int connectToRunningServer(const char *path) {
+    sockaddr_un address;
+    socklen_t addressLen;
+    if (not setUnixAddress(address, addressLen, path)) {
+        fatal("upgrade socket path %s is too long", path);
+    }
+
+    int upgradeFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (upgradeFd < 0) {
+        sysFatal("cannot create a socket");
+    }
+
+    if (connect(upgradeFd, (sockaddr *)&address, addressLen) < 0) {
+        close(upgradeFd);
+        return Constants::ERROR_CODE;
+    }
+
+    if (not setHandoverTimeout(upgradeFd)) {
+        sysFatal("cannot set timeout of upgrade socket");
+    }
+
+    return upgradeFd;
+}
+
+bool setHandoverTimeout(int upgradeFd) {
+    timeval timeout;
+    timeout.tv_sec = UpgradeConstants::HANDOVER_TIMEOUT / 1000;
+    timeout.tv_usec = (UpgradeConstants::HANDOVER_TIMEOUT % 1000) * 1000;
+
+    return setsockopt(upgradeFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) == 0 and
+           setsockopt(upgradeFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0;
+}
+
+bool sendState(int upgradeFd, const StateWriter &stateWriter) {
+    const std::string &state = stateWriter.getBuffer();
+    const std::vector<int> &fds = stateWriter.getFds();
+
+    std::string header;
+    appendBytes(header, state.size(), 8);
+    appendBytes(header, fds.size(), 8);
+    if (not sendAll(upgradeFd, header.data(), header.size()) or
+        not sendAll(upgradeFd, state.data(), state.size())) {
+        return false;
+    }
+
+    // Kernel limits descriptors per message, so they are sent in batches attached to one byte.
+    for (size_t sent = 0; sent < fds.size(); sent += UpgradeConstants::MAX_FDS_PER_MESSAGE) {
+        size_t batch = std::min(fds.size() - sent, (size_t)UpgradeConstants::MAX_FDS_PER_MESSAGE);
+
+        char byte = 0;
+        iovec iov = {&byte, 1};
+        std::vector<char> control(CMSG_SPACE(batch * sizeof(int)));
+
+        msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+        message.msg_control = control.data();
+        message.msg_controllen = control.size();
+
+        cmsghdr *header = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type = SCM_RIGHTS;
+        header->cmsg_len = CMSG_LEN(batch * sizeof(int));
+        memcpy(CMSG_DATA(header), fds.data() + sent, batch * sizeof(int));
+
+        if (sendmsg(upgradeFd, &message, MSG_NOSIGNAL) != 1) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool receiveState(int upgradeFd, std::string &state, std::vector<int> &fds) {
+    char header[UpgradeConstants::HEADER_SIZE];
+    if (not receiveAll(upgradeFd, header, sizeof(header))) {
+        return false;
+    }
+
+    uint64_t stateSize = readBytes(header, 8);
+    uint64_t fdsNumber = readBytes(header + 8, 8);
+
+    state.resize(stateSize);
+    if (not receiveAll(upgradeFd, state.data(), stateSize)) {
+        return false;
+    }
+
+    fds.clear();
+    std::vector<char> control(CMSG_SPACE(UpgradeConstants::MAX_FDS_PER_MESSAGE * sizeof(int)));
+    while (fds.size() < fdsNumber) {
+        char byte;
+        iovec iov = {&byte, 1};
+
+        msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+        message.msg_control = control.data();
+        message.msg_controllen = control.size();
+
+        if (recvmsg(upgradeFd, &message, MSG_CMSG_CLOEXEC) != 1 or
+            (message.msg_flags & MSG_CTRUNC)) {
+            return false;
+        }
+
+        for (cmsghdr *cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr;
+             cmsg = CMSG_NXTHDR(&message, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET or cmsg->cmsg_type != SCM_RIGHTS) {
+                continue;
+            }
+
+            size_t received = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            size_t offset = fds.size();
+            fds.resize(offset + received);
+            memcpy(fds.data() + offset, CMSG_DATA(cmsg), received * sizeof(int));
+        }
+    }
+
+    return true;
+}
+
+bool sendAck(int upgradeFd) {
+    return sendAll(upgradeFd, &UpgradeConstants::ACK, 1);
+}
+
+bool receiveAck(int upgradeFd) {
+    char byte;
+    return receiveAll(upgradeFd, &byte, 1) and byte == UpgradeConstants::ACK;
+}
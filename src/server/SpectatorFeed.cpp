@@ -0,0 +1,125 @@
+#include "server/SpectatorFeed.h"
+
+void SpectatorFeed::dropSpectator(int index, ServerContext &serverContext) {
+    removeSpectator(index);
+    serverContext.closeConnection(index, true);
+}
+
+void SpectatorFeed::addSpectator(int index, ServerContext &serverContext) {
+    if (index >= (int)cursors.size()) {
+        cursors.resize(serverContext.getSlotsNumber(), 0);
+    }
+    cursors[index] = handStart;
+    spectators.emplace_back(index);
+
+    serverContext.stopWaitingFor(index);
+    serverContext.setClientStateAt(index, CLIENT_STATE::SPECTATING);
+    if (cursors[index] < events.size()) {
+        serverContext.pollSetWrite(index);
+    }
+}
+
+void SpectatorFeed::removeSpectator(int index) {
+    for (size_t i = 0; i < spectators.size(); i++) {
+        if (spectators[i] == index) {
+            // Swap with last element.
+            std::swap(spectators[i], spectators.back());
+            spectators.pop_back();
+            return;
+        }
+    }
+}
+
+void SpectatorFeed::startHand() {
+    handStart = events.size();
+}
+
+void SpectatorFeed::startGame() {
+    startHand();
+
+    size_t base = handStart;
+    for (int index : spectators) {
+        base = std::min(base, cursors[index]);
+    }
+
+    // Erasing keeps capacity, so next game appends without reallocating.
+    events.erase(0, base);
+    handStart -= base;
+    for (int index : spectators) {
+        cursors[index] -= base;
+    }
+}
+
+void SpectatorFeed::appendEvent(std::string_view message, ServerContext &serverContext) {
+    events += message;
+
+    for (size_t i = 0; i < spectators.size();) {
+        int index = spectators[i];
+
+        // Spectator that cannot keep up is dropped, so that log is never held back for him.
+        if (events.size() - cursors[index] > SpectatorConstants::MAX_LAG) {
+            dropSpectator(index, serverContext);
+            continue; // Last spectator was swapped into position i.
+        }
+
+        serverContext.pollSetWrite(index);
+        i++;
+    }
+}
+
+void SpectatorFeed::writeToSpectator(int index, ServerContext &serverContext) {
+    // Room freed in shared memory may be reported when everything was already written.
+    if (cursors[index] == events.size()) {
+        serverContext.checkIfEmpty(index);
+        return;
+    }
+
+    ssize_t sentLen = serverContext.sendBytesServer(index, events.data() + cursors[index],
+                                                    events.size() - cursors[index]);
+    if (sentLen <= 0) {
+        if (sentLen < 0 and (errno == EAGAIN or errno == EWOULDBLOCK)) {
+            return;
+        }
+
+        dropSpectator(index, serverContext);
+        return;
+    }
+
+    cursors[index] += sentLen;
+    if (cursors[index] == events.size()) {
+        serverContext.checkIfEmpty(index);
+    }
+}
+
+void SpectatorFeed::serialize(StateWriter &stateWriter) {
+    stateWriter.writeString(events);
+    stateWriter.writeInt(handStart);
+
+    stateWriter.writeInt(spectators.size());
+    for (int index : spectators) {
+        stateWriter.writeInt(index);
+        stateWriter.writeInt(cursors[index]);
+    }
+}
+
+void SpectatorFeed::deserialize(StateReader &stateReader) {
+    events = stateReader.readString();
+    handStart = stateReader.readInt();
+
+    spectators.clear();
+    int64_t size = stateReader.readInt();
+    for (int64_t i = 0; i < size and not stateReader.hasFailed(); i++) {
+        int index = (int)stateReader.readInt();
+        size_t cursor = stateReader.readInt();
+        if (index < ServerConstants::FIRST_CONNECTION or
+            index >= ServerConstants::MAX_CONNECTIONS or cursor > events.size()) {
+            continue;
+        }
+
+        if (index >= (int)cursors.size()) {
+            cursors.resize(index + 1, 0);
+        }
+        spectators.emplace_back(index);
+        cursors[index] = cursor;
+    }
+}
@@ -0,0 +1,109 @@
+#include "server/StateSerializer.h"
+
+void appendBytes(std::string &buffer, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+uint64_t readBytes(const char *data, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    return value;
+}
+
+/// STATE WRITER ///
+
+void StateWriter::writeInt(int64_t value) {
+    appendBytes(buffer, static_cast<uint64_t>(value), 8);
+}
+
+void StateWriter::writeString(const std::string &value) {
+    writeInt(value.size());
+    buffer += value;
+}
+
+void StateWriter::writeCards(const std::vector<Card> &cards) {
+    writeInt(cards.size());
+    for (const auto &card : cards) {
+        writeInt(static_cast<int>(card.cardColor));
+        writeInt(card.cardValue);
+    }
+}
+
+void StateWriter::writeFd(int fd) {
+    if (fd < 0) {
+        writeInt(Constants::ERROR_CODE);
+        return;
+    }
+
+    writeInt(fds.size());
+    fds.emplace_back(fd);
+}
+
+const std::string &StateWriter::getBuffer() const {
+    return buffer;
+}
+
+const std::vector<int> &StateWriter::getFds() const {
+    return fds;
+}
+
+/// STATE READER ///
+
+StateReader::StateReader(std::string buffer, std::vector<int> fds)
+    : buffer(std::move(buffer)), fds(std::move(fds)) {}
+
+int64_t StateReader::readInt() {
+    if (failed or offset + 8 > buffer.size()) {
+        failed = true;
+        return 0;
+    }
+
+    auto value = static_cast<int64_t>(readBytes(buffer.data() + offset, 8));
+    offset += 8;
+    return value;
+}
+
+std::string StateReader::readString() {
+    int64_t size = readInt();
+    if (failed or size < 0 or offset + size > buffer.size()) {
+        failed = true;
+        return "";
+    }
+
+    std::string value = buffer.substr(offset, size);
+    offset += size;
+    return value;
+}
+
+std::vector<Card> StateReader::readCards() {
+    std::vector<Card> cards;
+    int64_t size = readInt();
+    for (int64_t i = 0; i < size and not failed; i++) {
+        Card card = Card();
+        card.cardColor = static_cast<CARD_COLOR>(readInt());
+        card.cardValue = (int)readInt();
+        cards.emplace_back(card);
+    }
+    return cards;
+}
+
+int StateReader::readFd() {
+    int64_t position = readInt();
+    if (position == Constants::ERROR_CODE) {
+        return Constants::ERROR_CODE;
+    }
+
+    if (position < 0 or position >= (int64_t)fds.size()) {
+        failed = true;
+        return Constants::ERROR_CODE;
+    }
+    return fds[position];
+}
+
+bool StateReader::hasFailed() const {
+    return failed;
+}
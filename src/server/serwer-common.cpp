@@ -1,120 +1,82 @@
 #include "server/serwer-common.h"
 
-/// @brief Function adds points to client.
-static void addPoints(ServerHand &hand, TABLE_PLACE client, int points) {
-    hand.playerScores[client] += points;
-}
-
-/// @brief Function handles bandit (hand type 7).
-static void handleBandit(ServerHand &hand, TABLE_PLACE client,
-                         const std::vector<Card> &takenCards) {
-    addPoints(hand, client, 1);
-
-    for (const auto card : takenCards) {
-        if (card.cardColor == CARD_COLOR::H) {
-            addPoints(hand, client, 1);
-        }
-        if (card.cardValue == static_cast<int>(CARD_VALUE::Q)) {
-            addPoints(hand, client, 5);
-        }
-        if (card.cardValue == static_cast<int>(CARD_VALUE::J) or
-            card.cardValue == static_cast<int>(CARD_VALUE::K)) {
-            addPoints(hand, client, 2);
-        }
-        if (card.cardValue == static_cast<int>(CARD_VALUE::K) and card.cardColor == CARD_COLOR::H) {
-            addPoints(hand, client, 18);
-        }
-    }
-
-    if (hand.currentTrick == 7 or hand.currentTrick == Constants::TRICK_NUMBER) {
-        addPoints(hand, client, 10);
-    }
-}
-
-/// @brief Function adjust points based on hand type.
+/// @brief Function adds penalty for taken cards based on hand type.
 static void adjustPoints(ServerHand &hand, TABLE_PLACE client,
                          const std::vector<Card> &takenCards) {
-    switch (hand.handType) {
-    case HAND_TYPE::DEFAULT:
-        addPoints(hand, client, 1);
-        break;
-
-    case HAND_TYPE::HEART:
-        for (const auto card : takenCards) {
-            if (card.cardColor == CARD_COLOR::H)
-                addPoints(hand, client, 1);
-        }
-        break;
-
-    case HAND_TYPE::QUEEN:
-        for (const auto card : takenCards) {
-            if (card.cardValue == static_cast<int>(CARD_VALUE::Q))
-                addPoints(hand, client, 5);
-        }
-        break;
-
-    case HAND_TYPE::GUYS:
-        for (const auto card : takenCards) {
-            if (card.cardValue == static_cast<int>(CARD_VALUE::J) or
-                card.cardValue == static_cast<int>(CARD_VALUE::K))
-                addPoints(hand, client, 2);
-        }
-        break;
-
-    case HAND_TYPE::HEART_KING:
-        for (const auto card : takenCards) {
-            if (card.cardValue == static_cast<int>(CARD_VALUE::K) and
-                card.cardColor == CARD_COLOR::H)
-                addPoints(hand, client, 18);
-        }
-        break;
+    hand.playerScores[client] +=
+        getTrickPenalty(hand.handType, getCardsMask(takenCards), hand.currentTrick);
+}
 
-    case HAND_TYPE::SEVEN_N_LAST:
-        if (hand.currentTrick == 7 or hand.currentTrick == Constants::TRICK_NUMBER)
-            addPoints(hand, client, 10);
-        break;
+/// @brief Function returns client with highest card and adjust his points.
+static TABLE_PLACE takesTrick(ServerHand &hand) {
+    int winnerOffset = getTrickWinner(packTrick(hand.currentlyPlacedCards));
+    int winnerIndex =
+        (static_cast<int>(hand.previousTrickTaker) + winnerOffset) % Constants::PLAYERS_NUMBER;
 
-    case HAND_TYPE::BANDIT:
-        handleBandit(hand, client, takenCards);
-        break;
+    hand.previousTrickTaker = static_cast<TABLE_PLACE>(winnerIndex);
+    adjustPoints(hand, hand.previousTrickTaker, hand.currentlyPlacedCards);
 
-    default:
-        break;
-    }
+    return hand.previousTrickTaker;
 }
 
-/// @brief Function returns client with highest card and adjust his points.
-static char takesTrick(ServerHand &hand) {
-    int currentIndex = static_cast<int>(hand.previousTrickTaker);
-    char highestClient = tablePlaceToChar(currentIndex);
-
-    Card highestCard = hand.currentlyPlacedCards[0];
+/// @brief Function returns taken message, builds its binary form and sets previous trick taker.
+Frame getTakenMessage(ServerHand &hand, Frame &binaryTakenMessage) {
+    TABLE_PLACE taker = takesTrick(hand);
+    binaryTakenMessage = getBinaryTakenFrame(hand.currentTrick, hand.currentlyPlacedCards, taker);
+    return getTakenFrame(hand.currentTrick, hand.currentlyPlacedCards, taker);
+}
 
-    for (int i = 1; i < Constants::PLAYERS_NUMBER; i++) {
-        currentIndex = (currentIndex + 1) % Constants::PLAYERS_NUMBER;
+/// @brief Returns local address of connected socket to log.
+std::string getLocalIpv6AndPortAddress(int socketFd) {
+    struct sockaddr_in6 localAddress;
+    socklen_t localAddressLen = sizeof(localAddress);
+    memset(&localAddress, 0, localAddressLen);
 
-        if (hand.currentlyPlacedCards[i].cardColor == highestCard.cardColor and
-            hand.currentlyPlacedCards[i].cardValue > highestCard.cardValue) {
+    // Find out what port the server is actually listening on.
+    if (getsockname(socketFd, (struct sockaddr *)&localAddress, &localAddressLen) < 0) {
+        sysError("getsockname");
+    }
 
-            highestClient = tablePlaceToChar(currentIndex);
-            hand.previousTrickTaker = static_cast<TABLE_PLACE>(currentIndex);
+    return getIpv6AndPortAddress(localAddress);
+}
 
-            highestCard = hand.currentlyPlacedCards[i];
-        }
+/// @brief Returns local address of connection to log. Connections accepted on unix socket have
+/// AF_UNIX in place of client address family.
+std::string getLocalAddressStr(int socketFd, const sockaddr_in6 &clientAddress) {
+    if (clientAddress.sin6_family != AF_UNIX) {
+        return getLocalIpv6AndPortAddress(socketFd);
     }
 
-    adjustPoints(hand, charToTablePlace(highestClient), hand.currentlyPlacedCards);
+    sockaddr_un localAddress;
+    socklen_t localAddressLen = sizeof(localAddress);
+    memset(&localAddress, 0, localAddressLen);
+    if (getsockname(socketFd, (struct sockaddr *)&localAddress, &localAddressLen) < 0) {
+        sysError("getsockname");
+    }
 
-    return highestClient;
+    // Abstract name starts with zero byte and is not terminated, path is.
+    std::string path(localAddress.sun_path,
+                     std::max<socklen_t>(localAddressLen, offsetof(sockaddr_un, sun_path)) -
+                         offsetof(sockaddr_un, sun_path));
+    if (not path.empty() and path[0] == 0) {
+        path[0] = SocketConstants::ABSTRACT_PREFIX;
+    } else {
+        path = path.c_str();
+    }
+    return SocketConstants::UNIX_PREFIX + path;
 }
 
-/// @brief Function returns taken string and sets previous trick taker.
-std::string getTakenStr(ServerHand &hand) {
-    std::string message = Messages::TAKEN;
-    message += std::to_string(hand.currentTrick);
-    message += getCardsStr(hand.currentlyPlacedCards);
-    message.push_back(takesTrick(hand));
-    message += Messages::END_OF_MESSAGE;
+/// @brief Returns client address of connection to log.
+std::string getClientAddressStr(int socketFd, const sockaddr_in6 &clientAddress) {
+    if (clientAddress.sin6_family != AF_UNIX) {
+        return getIpv6AndPortAddress(clientAddress);
+    }
 
-    return message;
+    struct ucred credentials;
+    socklen_t credentialsLen = sizeof(credentials);
+    if (getsockopt(socketFd, SOL_SOCKET, SO_PEERCRED, &credentials, &credentialsLen) < 0) {
+        sysError("getsockopt");
+        credentials.pid = 0;
+    }
+    return getUnixPeerAddress(credentials.pid);
 }
@@ -2,53 +2,81 @@
 
 /// Every message that is parsed here ends with "\r\n". ///
 
+/// @brief Returns true if message is IAM with binary protocol flag.
+bool asksForBinary(const std::string &message) {
+    return message.size() == 7 and message[4] == BinaryConstants::IAM_FLAG;
+}
+
 /// @brief Returns TABLE_PLACE from IAM message or UNDEFINED if error occurred.
 TABLE_PLACE parseIam(const std::string &message) {
-    // message ? IAM.\r\n
-    if (message.size() != 6 or not canBeIam(message)) {
+    // message ? IAM.\r\n or IAM.B\r\n
+    if ((message.size() != 6 and not asksForBinary(message)) or not canBeIam(message)) {
         return TABLE_PLACE::UNDEFINED;
     }
 
     return charToTablePlace(message[3]);
 }
 
+/// @brief Returns true if message is SPECTATE.
+bool parseSpectate(const std::string &message) {
+    return message == Messages::SPECTATE + Messages::END_OF_MESSAGE;
+}
+
+/// @brief Returns true if message is SHM.
+bool parseShm(const std::string &message) {
+    return message == Messages::SHM + Messages::END_OF_MESSAGE;
+}
+
 /// @brief Returns busy message.
-std::string getBusyMessage(ServerContext &serverContext) {
-    std::string message = Messages::BUSY;
+Frame getBusyMessage(ServerContext &serverContext) {
+    uint32_t takenPlacesMask = 0;
     for (int i = 0; i < ServerConstants::ACCEPT_INDEX; i++) {
         if (serverContext.isDescriptorReserved(i)) {
-            message += tablePlaceToChar(i);
+            takenPlacesMask |= 1U << i;
         }
     }
 
-    message += Messages::END_OF_MESSAGE;
+    return getBusyFrame(takenPlacesMask);
+}
 
-    return message;
+/// @brief Returns deal followed by taken messages.
+static std::string joinDealTaken(const std::string &dealStr, const std::string &previousTaken) {
+    std::string dealMessage;
+    dealMessage.reserve(dealStr.size() + previousTaken.size());
+    dealMessage += dealStr;
+    dealMessage += previousTaken;
+    return dealMessage;
 }
 
-/// @brief Appends deal and (if client disconnected) taken messages to given write buffer.
+/// @brief Appends deal and (if client disconnected) taken messages to given write buffer. They
+/// are appended as a single message, so that catch-up is sent with as few writes as possible.
+/// Only the form used by the client is joined.
 void setDealTakenMessage(TABLE_PLACE tablePlace, ServerStatus &serverStatus,
                          ServerContext &serverContext) {
     int index = static_cast<int>(tablePlace);
-    std::string dealMessage = serverStatus.getCurrentHand().dealStrAtPlace[tablePlace];
+    ServerHand &hand = serverStatus.getCurrentHand();
 
-    serverContext.appendMessageToWriteAt(index, dealMessage);
-
-    for (const auto &takenStr : serverStatus.getPreviousTakenList()) {
-        serverContext.appendMessageToWriteAt(index, takenStr);
+    std::string dealMessage, binaryDealMessage;
+    if (serverContext.isBinaryAt(index)) {
+        binaryDealMessage =
+            joinDealTaken(hand.dealBinaryAtPlace[tablePlace], hand.previousTakenBinary);
+    } else {
+        dealMessage = joinDealTaken(hand.dealStrAtPlace[tablePlace], hand.previousTaken);
     }
+
+    serverContext.appendMessageToWriteAt(index, dealMessage, binaryDealMessage);
 }
 
 /// @brief Returns trick message.
-std::string getTrickMessage(ServerStatus &serverStatus) {
-    ServerHand hand = serverStatus.getCurrentHand();
-
-    std::string message = Messages::TRICK;
-    message += std::to_string(hand.currentTrick);
-    message += getCardsStr(hand.currentlyPlacedCards);
-    message += Messages::END_OF_MESSAGE;
+Frame getTrickMessage(ServerStatus &serverStatus) {
+    ServerHand &hand = serverStatus.getCurrentHand();
+    return getTrickFrame(hand.currentTrick, hand.currentlyPlacedCards);
+}
 
-    return message;
+/// @brief Returns trick message in binary form.
+Frame getBinaryTrickMessage(ServerStatus &serverStatus) {
+    ServerHand &hand = serverStatus.getCurrentHand();
+    return getBinaryTrickFrame(hand.currentTrick, hand.currentlyPlacedCards);
 }
 
 /// @brief Returns true if trick message can be parsed.
@@ -70,6 +98,16 @@ bool canTrickBeParsed(std::string message) {
     return true;
 }
 
+/// @brief Returns true if trick message can be parsed, trick read from binary message is checked
+/// instead of text if there is one.
+bool canTrickBeParsed(const std::string &message, const CardsMessage &trick) {
+    if (not trick.parsed) {
+        return canTrickBeParsed(message);
+    }
+
+    return trick.type == BINARY_TYPE::TRICK and trick.cards.size() == 1;
+}
+
 /// @brief Returns true and deletes card if client send correct TRICK message and false otherwise.
 bool parseTrickServer(std::string message, ServerStatus &serverStatus, TABLE_PLACE currentPlayer) {
     // message ? TRICK..\r\n
@@ -90,31 +128,31 @@ bool parseTrickServer(std::string message, ServerStatus &serverStatus, TABLE_PLA
     return serverStatus.playerPlacesCard(currentPlayer, placedCards.back());
 }
 
-/// @brief Returns wrong message.
-std::string getWrongMessage(ServerStatus &serverStatus) {
-    std::string message = Messages::WRONG;
-    message += std::to_string(serverStatus.getCurrentHand().currentTrick);
-    message += Messages::END_OF_MESSAGE;
+/// @brief Same as parseTrickServer on text, but uses trick read from binary message if there is
+/// one.
+bool parseTrickServer(const std::string &message, const CardsMessage &trick,
+                      ServerStatus &serverStatus, TABLE_PLACE currentPlayer) {
+    if (not trick.parsed) {
+        return parseTrickServer(message, serverStatus, currentPlayer);
+    }
+
+    if (trick.type != BINARY_TYPE::TRICK or trick.trickNumber != serverStatus.getCurrentTrick() or
+        trick.cards.size() != 1) {
+        return false;
+    }
 
-    return message;
+    return serverStatus.playerPlacesCard(currentPlayer, trick.cards.back());
 }
 
-/// @brief Returns results string specified in which.
-std::string getResultsMessage(ServerStatus &serverStatus, const std::string &which) {
-    std::string message = which;
+/// @brief Returns wrong message.
+Frame getWrongMessage(ServerStatus &serverStatus) {
+    return getWrongFrame(serverStatus.getCurrentHand().currentTrick);
+}
 
-    if (which == "SCORE") {
-        for (auto &[place, score] : serverStatus.getCurrentHand().playerScores) {
-            message += tablePlaceToChar(static_cast<int>(place));
-            message += std::to_string(score);
-        }
-    } else {
-        for (auto &[place, score] : serverStatus.playerTotalScores) {
-            message += tablePlaceToChar(static_cast<int>(place));
-            message += std::to_string(score);
-        }
+/// @brief Returns results message specified in which.
+Frame getResultsMessage(ServerStatus &serverStatus, const std::string &which) {
+    if (which == Messages::SCORE) {
+        return getResultsFrame(which, serverStatus.getCurrentHand().playerScores);
     }
-
-    message += Messages::END_OF_MESSAGE;
-    return message;
+    return getResultsFrame(which, serverStatus.playerTotalScores);
 }
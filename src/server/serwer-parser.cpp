@@ -14,30 +14,41 @@ static int readTimeout(char const *string) {
     return (int)timeout;
 }
 
-/// @brief Function returns char from hand type.
-static char handTypeToChar(HAND_TYPE handType) {
-    if (handType != HAND_TYPE::UNDEFINED) {
-        return static_cast<char>(static_cast<int>(handType) + '0');
+static int readQueueLength(char const *string) {
+    char *endptr;
+    errno = 0;
+    unsigned long queueLength = strtoul(string, &endptr, 10);
+    if (errno != 0 or *endptr != 0 or queueLength == 0 or queueLength > INT32_MAX) {
+        fatal("%s is not a valid queue length", string);
+    }
+    return (int)queueLength;
+}
+
+static size_t readByteLimit(char const *string) {
+    char *endptr;
+    errno = 0;
+    unsigned long long limit = strtoull(string, &endptr, 10);
+    if (errno != 0 or *endptr != 0 or string[0] == '-' or
+        limit < (unsigned long long)ServerConstants::BUFFER_SIZE or limit > INT32_MAX) {
+        fatal("%s is not a valid byte limit", string);
     }
-    return '?';
+    return (size_t)limit;
 }
 
-/// @brief Function set deal message for player at given tablePlace.
-static void setDealStr(ServerHand &hand, TABLE_PLACE tablePlace) {
-    std::string message = Messages::DEAL;
-    message += handTypeToChar(hand.handType);
-    message += tablePlaceToChar(static_cast<int>(hand.previousTrickTaker));
-    message += getCardsStr(hand.playerCards[tablePlace]);
-    message += Messages::END_OF_MESSAGE;
+/// @brief Function set deal message in text and binary form for player at given tablePlace.
+static void setDealStr(ServerHand &hand, TABLE_PLACE tablePlace, std::vector<Card> &cards) {
+    Frame dealMessage = getDealFrame(hand.handType, hand.previousTrickTaker, cards);
+    hand.dealStrAtPlace[tablePlace] = std::string(dealMessage.view());
 
-    hand.dealStrAtPlace[tablePlace] = message;
+    Frame binaryDealMessage = getBinaryDealFrame(hand.handType, hand.previousTrickTaker, cards);
+    hand.dealBinaryAtPlace[tablePlace] = std::string(binaryDealMessage.view());
 }
 
-/// @brief Function reads game file provided by user.
-static void parseGameFile(ServerArguments &serverArguments, ServerStatus &serverStatus) {
-    std::ifstream gameFile(serverArguments.fileStr);
+/// @brief Function reads game file at given path.
+static void parseGameFile(const char *fileStr, ServerStatus &serverStatus) {
+    std::ifstream gameFile(fileStr);
     if (not gameFile.is_open()) {
-        sysFatal("cannot open file %s", serverArguments.fileStr);
+        sysFatal("cannot open file %s", fileStr);
     }
 
     std::string line;
@@ -54,10 +65,11 @@ static void parseGameFile(ServerArguments &serverArguments, ServerStatus &server
             TABLE_PLACE tablePlace = charToTablePlace(placeChar);
 
             std::getline(gameFile, line);
-            currentHand.playerCards[tablePlace] = parseCardsVector(line, 0, line.size()).second;
+            std::vector<Card> cards = parseCardsVector(line, 0, line.size()).second;
+            currentHand.playerCards[static_cast<int>(tablePlace)] = getCardsMask(cards);
 
             currentHand.playerScores[tablePlace] = 0;
-            setDealStr(currentHand, tablePlace);
+            setDealStr(currentHand, tablePlace, cards);
         }
 
         serverStatus.hands.emplace_back(currentHand);
@@ -66,44 +78,95 @@ static void parseGameFile(ServerArguments &serverArguments, ServerStatus &server
 
 /// @brief Checks if client parameters are in proper form.
 static void validateServerParameters(int argc, char **argv) {
-    for (int i = 1; i < argc; i += 2) {
+    for (int i = 1; i < argc;) {
         std::string param(argv[i]);
 
         if (param.size() != 2 or param[0] != '-') {
             fatal("unknown option");
         }
 
-        if (param[1] != 'p' and param[1] != 'f' and param[1] != 't') {
+        if (param[1] == 'l' or param[1] == 's' or param[1] == 'd') {
+            i += 1;
+            continue;
+        }
+
+        if (param[1] != 'p' and param[1] != 'f' and param[1] != 't' and param[1] != 'm' and
+            param[1] != 'q' and param[1] != 'j' and param[1] != 'u' and param[1] != 'r' and
+            param[1] != 'w' and param[1] != 'o' and param[1] != 'x' and param[1] != 'b' and
+            param[1] != 'g') {
             fatal("unknown option -%c", param[1]);
         }
 
         if (i + 1 >= argc or argv[i + 1][0] == '-') {
             fatal("Parameter -%c is not followed by an argument", param[1]);
         }
+
+        i += 2;
     }
 }
 
-/// @brief Function parses arguments passed by user and reads game file.
+/// @brief Function parses arguments passed by user and reads game files, one game per file.
 void parseUserInput(int argc, char **argv, ServerArguments &serverArguments,
-                    ServerStatus &serverStatus) {
+                    std::vector<ServerStatus> &games) {
     validateServerParameters(argc, argv);
 
     opterr = 0;
     int c;
 
-    while ((c = getopt(argc, argv, "p:f:t:")) != -1)
+    while ((c = getopt(argc, argv, "p:f:t:m:q:j:u:r:w:o:x:b:g:lsd")) != -1)
         switch (c) {
         case 'p':
             serverArguments.portStr = optarg;
             break;
         case 'f':
-            serverArguments.fileStr = optarg;
+            serverArguments.fileStrs.emplace_back(optarg);
             break;
         case 't':
             serverArguments.timeoutStr = optarg;
             break;
+        case 'm':
+            serverArguments.metricsPortStr = optarg;
+            break;
+        case 'q':
+            serverArguments.queueLengthStr = optarg;
+            break;
+        case 'j':
+            serverArguments.journalStr = optarg;
+            break;
+        case 'u':
+            serverArguments.upgradeStr = optarg;
+            break;
+        case 'r':
+            serverArguments.readLimitStr = optarg;
+            break;
+        case 'w':
+            serverArguments.writeLimitStr = optarg;
+            break;
+        case 'o':
+            serverArguments.socketOptionsStr = optarg;
+            break;
+        case 'x':
+            serverArguments.unixPathStr = optarg;
+            break;
+        case 'b':
+            serverArguments.botGraceStr = optarg;
+            break;
+        case 'g':
+            serverArguments.reportStr = optarg;
+            break;
+        case 'l':
+            serverArguments.lobbyEnabled = true;
+            break;
+        case 's':
+            serverArguments.spectatorsEnabled = true;
+            break;
+        case 'd':
+            serverArguments.daemonEnabled = true;
+            break;
         case '?':
-            if (optopt == 'p' or optopt == 'f' or optopt == 't')
+            if (optopt == 'p' or optopt == 'f' or optopt == 't' or optopt == 'm' or optopt == 'q' or
+                optopt == 'j' or optopt == 'u' or optopt == 'r' or optopt == 'w' or
+                optopt == 'o' or optopt == 'x' or optopt == 'b' or optopt == 'g')
                 fatal("Option -%c requires an argument.\n", optopt);
             if (isprint(optopt))
                 fatal("Unknown option `-%c'.\n", optopt);
@@ -112,17 +175,49 @@ void parseUserInput(int argc, char **argv, ServerArguments &serverArguments,
             sysFatal("getopt");
         }
 
-    if (serverArguments.fileStr == nullptr) {
+    if (serverArguments.fileStrs.empty()) {
         fatal("file required");
     }
 
-    parseGameFile(serverArguments, serverStatus);
+    if (serverArguments.fileStrs.size() > 1 and not serverArguments.daemonEnabled) {
+        fatal("more than one file requires -d");
+    }
+
+    // Deals are parsed once, daemon only copies them when it starts next game.
+    games.resize(serverArguments.fileStrs.size());
+    for (size_t game = 0; game < games.size(); game++) {
+        parseGameFile(serverArguments.fileStrs[game], games[game]);
+    }
 
     if (serverArguments.timeoutStr != nullptr) {
         serverArguments.timeout = readTimeout(serverArguments.timeoutStr);
     }
 
+    if (serverArguments.botGraceStr != nullptr) {
+        serverArguments.botGrace = readTimeout(serverArguments.botGraceStr);
+    }
+
     if (serverArguments.portStr != nullptr) {
         serverArguments.port = readPort(serverArguments.portStr);
     }
+
+    if (serverArguments.metricsPortStr != nullptr) {
+        serverArguments.metricsPort = readPort(serverArguments.metricsPortStr);
+    }
+
+    if (serverArguments.queueLengthStr != nullptr) {
+        serverArguments.queueLength = readQueueLength(serverArguments.queueLengthStr);
+    }
+
+    if (serverArguments.readLimitStr != nullptr) {
+        serverArguments.readLimit = readByteLimit(serverArguments.readLimitStr);
+    }
+
+    if (serverArguments.writeLimitStr != nullptr) {
+        serverArguments.writeLimit = readByteLimit(serverArguments.writeLimitStr);
+    }
+
+    if (serverArguments.socketOptionsStr != nullptr) {
+        serverArguments.socketOptions = readSocketOptions(serverArguments.socketOptionsStr);
+    }
 }
@@ -0,0 +1,27 @@
+#!/bin/bash
+# Binary clients sit at the table with a text one. Second W joins in binary from the lobby once
+# first W leaves, so it gets the deal and tricks taken so far in binary.
+source "$(dirname "$0")/lib.sh"
+
+PORT=$(free_port)
+timeout $LIMIT "$SERVER" -f "$GAME" -p "$PORT" -t 2 -l > "$WORK/server.log" 2>&1 &
+SERVER_PID=$!
+wait_for_port "$PORT"
+
+$PLAYER -p "$PORT" --seat W --leave-after 5 > "$WORK/W1.log" 2>&1 &
+wait_for_log server.log IAMW
+timeout $LIMIT "$CLIENT" -h localhost -p "$PORT" -W -a -b > "$WORK/W2.log" 2>&1 &
+wait_for_log server.log QUEUE1
+for seat in N E; do
+    timeout $LIMIT "$CLIENT" -h localhost -p "$PORT" -"$seat" -a -b > "$WORK/$seat.log" 2>&1 &
+done
+start_clients "$PORT" S
+
+expect_exit $SERVER_PID 0 server
+wait
+expect_total N.log E.log S.log W2.log
+expect_field W1.log TAKEN 5
+wait_for_log server.log IAMWB
+wait_for_log W2.log TAKEN5
+[ "$(grep -c WRONG "$WORK/server.log")" -eq 0 ] || fail "server sent WRONG"
+pass
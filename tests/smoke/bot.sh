@@ -0,0 +1,28 @@
+#!/bin/bash
+# W leaves and server plays its seat once grace period is over. S holds the game up, so W comes
+# back in the middle of it, takes its seat over again and plays to the end.
+source "$(dirname "$0")/lib.sh"
+
+PORT=$(free_port)
+timeout $LIMIT "$SERVER" -f "$GAME" -p "$PORT" -t 5 -b 1 -g "$WORK/report.txt" \
+    > "$WORK/server.log" 2>&1 &
+SERVER_PID=$!
+wait_for_port "$PORT"
+
+start_clients "$PORT" N E
+$PLAYER -p "$PORT" --seat S --pause-after 8 --pause-file "$WORK/paused" \
+    --resume-file "$WORK/resume" > "$WORK/S.log" 2>&1 &
+$PLAYER -p "$PORT" --seat W --leave-after 5 --rejoin-after 1.5 > "$WORK/W.log" 2>&1 &
+
+# Tricks after W left are played only once server took W's seat.
+wait_for_file "$WORK/paused"
+wait_for_log server.log IAMW 2
+touch "$WORK/resume"
+
+expect_exit $SERVER_PID 0 server
+wait
+expect_total N.log E.log S.log W.log
+expect_field W.log connections 2
+grep -q "^seat=W .* bot_cards=[1-9][0-9]* .* reconnects=1$" "$WORK/report.txt" ||
+    fail "server did not play W: $(grep "^seat=W" "$WORK/report.txt")"
+pass
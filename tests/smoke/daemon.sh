@@ -0,0 +1,38 @@
+#!/bin/bash
+# Daemon plays three games in a row for clients playing sessions of three games, while one
+# spectator watches all of them. Server keeps running once they are gone.
+source "$(dirname "$0")/lib.sh"
+
+GAMES=3
+PORT=$(free_port)
+timeout $LIMIT "$SERVER" -f "$GAME" -p "$PORT" -t 5 -s -d > "$WORK/server.log" 2>&1 &
+SERVER_PID=$!
+wait_for_port "$PORT"
+
+$PLAYER -p "$PORT" --spectate --totals $((GAMES * 2)) > "$WORK/spectator.log" 2>&1 &
+SPECTATOR_PID=$!
+wait_for_log server.log SPECTATE
+
+for seat in N E S W; do
+    timeout $LIMIT "$CLIENT" -h localhost -p "$PORT" -"$seat" -a -g $GAMES \
+        > "$WORK/$seat.log" 2>&1 &
+    PIDS+=($!)
+done
+for pid in "${PIDS[@]}"; do
+    expect_exit "$pid" 0 "client"
+done
+expect_exit $SPECTATOR_PID 0 "spectator"
+
+kill -0 $SERVER_PID 2>/dev/null || fail "daemon exited"
+kill $SERVER_PID
+wait
+
+for seat in N E S W; do
+    [ "$(grep -c "$EXPECTED_TOTAL" "$WORK/$seat.log")" -eq $GAMES ] ||
+        fail "$seat.log did not end $GAMES games with $EXPECTED_TOTAL"
+done
+expect_field spectator.log DEAL $((GAMES * 8))
+expect_field spectator.log TAKEN $((GAMES * 26))
+expect_field spectator.log TOTAL $((GAMES * 2))
+expect_field spectator.log last "$EXPECTED_TOTAL"
+pass
@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+"""Scripted client for smoke checks.
+
+Plays a seat placing the lowest legal card, like the automatic client, and can leave, rejoin,
+ignore a TRICK or pause at given points of the game. With --spectate it only reads the event
+stream. On exit it prints what it received as one line of key=value pairs.
+"""
+
+import argparse
+import os
+import re
+import socket
+import sys
+import time
+
+VALUES = "23456789TJQKA"
+COLORS = "CDHS"
+CARD = re.compile(r"(10|[2-9JQKA])([CDHS])")
+TYPES = ["QUEUE", "BUSY", "DEAL", "TRICK", "WRONG", "TAKEN", "SCORE", "TOTAL"]
+
+
+def parse_cards(text):
+    return CARD.findall(text)
+
+
+def card_id(card):
+    value = "T" if card[0] == "10" else card[0]
+    return COLORS.index(card[1]) * len(VALUES) + VALUES.index(value)
+
+
+def connect(args):
+    if args.unix is not None:
+        sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        sock.connect(args.unix)
+    else:
+        sock = socket.create_connection(("localhost", args.port))
+    sock.settimeout(args.timeout)
+    return sock
+
+
+def messages(sock):
+    buffer = b""
+    while True:
+        data = sock.recv(4096)
+        if not data:
+            return
+        buffer += data
+        while b"\r\n" in buffer:
+            line, buffer = buffer.split(b"\r\n", 1)
+            yield line.decode()
+
+
+class Player:
+    def __init__(self, args):
+        self.args = args
+        self.counts = {kind: 0 for kind in TYPES}
+        self.connections = 0
+        self.last_total = None
+        self.tricks_seen = set()  # (deal, trick) pairs, catch-up after rejoin repeats them
+        self.hand = []
+        self.deal = None
+        self.taken_in_hand = 0
+        self.left = False
+        self.ignored = False
+        self.paused = False
+
+    def count(self, message):
+        for kind in TYPES:
+            if message.startswith(kind):
+                self.counts[kind] += 1
+                return
+
+    def on_taken(self, message):
+        trick = str(self.taken_in_hand + 1)
+        for card in parse_cards(message[len("TAKEN") + len(trick):-1]):
+            if card in self.hand:
+                self.hand.remove(card)
+        self.taken_in_hand += 1
+        self.tricks_seen.add((self.deal, self.taken_in_hand))
+
+    def on_trick(self, sock, message):
+        args = self.args
+        tricks = len(self.tricks_seen)
+
+        if args.ignore_after is not None and not self.ignored and tricks >= args.ignore_after:
+            self.ignored = True
+            return
+
+        if args.pause_after is not None and not self.paused and tricks >= args.pause_after:
+            self.paused = True
+            open(args.pause_file, "w").close()
+            while not os.path.exists(args.resume_file):
+                time.sleep(0.01)
+
+        trick = str(self.taken_in_hand + 1)
+        placed = parse_cards(message[len("TRICK") + len(trick):])
+        following = [card for card in self.hand if placed and card[1] == placed[0][1]]
+        card = min(following or self.hand, key=card_id)
+        sock.sendall(("TRICK" + trick + card[0] + card[1] + "\r\n").encode())
+
+    def play_connection(self, sock):
+        """Returns True if player left on purpose and should rejoin."""
+        for message in messages(sock):
+            self.count(message)
+            if message.startswith("DEAL"):
+                self.deal = message
+                self.hand = parse_cards(message[len("DEAL") + 2:])
+                self.taken_in_hand = 0
+            elif message.startswith("TAKEN"):
+                self.on_taken(message)
+                if (self.args.leave_after is not None and not self.left and
+                        len(self.tricks_seen) >= self.args.leave_after):
+                    self.left = True
+                    return True
+            elif message.startswith("TOTAL"):
+                self.last_total = message
+            elif message.startswith("TRICK"):
+                self.on_trick(sock, message)
+        return False
+
+    def play(self):
+        while True:
+            sock = connect(self.args)
+            self.connections += 1
+            sock.sendall(("IAM" + self.args.seat + "\r\n").encode())
+            rejoin = self.play_connection(sock)
+            sock.close()
+            if not rejoin or self.args.rejoin_after is None:
+                return
+            time.sleep(self.args.rejoin_after)
+
+    def spectate(self):
+        sock = connect(self.args)
+        self.connections += 1
+        sock.sendall(b"SPECTATE\r\n")
+        for message in messages(sock):
+            self.count(message)
+            if message.startswith("TOTAL"):
+                self.last_total = message
+                if self.counts["TOTAL"] == self.args.totals:
+                    break
+        sock.close()
+
+    def report(self):
+        who = "spectator" if self.args.spectate else "seat=" + self.args.seat
+        fields = [who, "connections=%d" % self.connections]
+        fields += ["%s=%d" % (kind, self.counts[kind]) for kind in TYPES]
+        fields.append("last=%s" % self.last_total)
+        print(" ".join(fields), flush=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    target = parser.add_mutually_exclusive_group(required=True)
+    target.add_argument("-p", "--port", type=int)
+    target.add_argument("-x", "--unix", help="path of server unix socket")
+    role = parser.add_mutually_exclusive_group(required=True)
+    role.add_argument("--seat", choices=["N", "E", "S", "W"])
+    role.add_argument("--spectate", action="store_true")
+    parser.add_argument("--leave-after", type=int, help="leave after this many tricks")
+    parser.add_argument("--rejoin-after", type=float, help="rejoin after this many seconds")
+    parser.add_argument("--ignore-after", type=int,
+                        help="do not answer first TRICK after this many tricks")
+    parser.add_argument("--pause-after", type=int,
+                        help="create pause file after this many tricks and wait for resume file")
+    parser.add_argument("--pause-file")
+    parser.add_argument("--resume-file")
+    parser.add_argument("--totals", type=int,
+                        help="stop spectating after this many TOTAL, daemon never closes")
+    parser.add_argument("--timeout", type=float, default=20)
+    args = parser.parse_args()
+
+    player = Player(args)
+    try:
+        if args.spectate:
+            player.spectate()
+        else:
+            player.play()
+    except (OSError, socket.timeout) as error:
+        print("error=%s" % error, file=sys.stderr)
+        player.report()
+        return 1
+
+    player.report()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,95 @@
+#!/bin/bash
+# Helpers of smoke checks. Every check plays sample_game.txt with the lowest legal card on every
+# seat, so whoever plays a seat, each player ends with the same TOTAL.
+
+SMOKE_DIR=$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)
+ROOT=$(cd "$SMOKE_DIR/../.." && pwd)
+SERVER="$ROOT/bin/kierki-serwer"
+CLIENT="$ROOT/bin/kierki-klient"
+PLAYER="python3 $SMOKE_DIR/kierki_player.py"
+GAME="$ROOT/sample_game.txt"
+EXPECTED_TOTAL="TOTALN2E6S4W14"
+CHECK=$(basename "$0" .sh)
+LIMIT=30
+
+WORK=$(mktemp -d)
+trap 'kill $(jobs -p) 2>/dev/null; wait 2>/dev/null; rm -rf "$WORK"' EXIT
+
+fail() {
+    echo "FAIL $CHECK: $*"
+    for log in "$WORK"/*.log; do
+        echo "--- $(basename "$log")"
+        tail -5 "$log"
+    done
+    exit 1
+}
+
+pass() {
+    echo "PASS $CHECK"
+}
+
+# Prints a TCP port nobody listens on.
+free_port() {
+    python3 -c 'import socket; s = socket.socket(); s.bind(("", 0)); print(s.getsockname()[1])'
+}
+
+# Waits until server listens on given TCP port.
+wait_for_port() {
+    python3 - "$1" <<'EOF' || fail "server is not listening on port $1"
+import socket, sys, time
+for _ in range(200):
+    try:
+        socket.create_connection(("localhost", int(sys.argv[1]))).close()
+        sys.exit(0)
+    except OSError:
+        time.sleep(0.025)
+sys.exit(1)
+EOF
+}
+
+# Waits until given file exists.
+wait_for_file() {
+    for _ in $(seq 400); do
+        [ -e "$1" ] && return 0
+        sleep 0.025
+    done
+    fail "$1 did not appear"
+}
+
+# Waits until given log has given number of lines matching pattern, 1 by default.
+wait_for_log() {
+    for _ in $(seq 400); do
+        [ "$(grep -c "$2" "$WORK/$1")" -ge "${3:-1}" ] && return 0
+        sleep 0.025
+    done
+    fail "$1 has no $2"
+}
+
+# Starts automatic clients on given TCP port for given seats, logging to <seat>.log.
+start_clients() {
+    local port=$1
+    shift
+    for seat in "$@"; do
+        timeout $LIMIT "$CLIENT" -h localhost -p "$port" -"$seat" -a > "$WORK/$seat.log" 2>&1 &
+    done
+}
+
+# Checks that each given log ends the game with expected TOTAL.
+expect_total() {
+    for log in "$@"; do
+        grep -q "$EXPECTED_TOTAL" "$WORK/$log" || fail "$log did not end with $EXPECTED_TOTAL"
+    done
+}
+
+# Checks that report of scripted client in given log has field with given value.
+expect_field() {
+    grep -q "\(^\| \)$2=$3\( \|$\)" "$WORK/$1" ||
+        fail "$1 expected $2=$3, got: $(tail -1 "$WORK/$1")"
+}
+
+# Waits for process with given pid and checks its exit status.
+expect_exit() {
+    wait "$1"
+    local status=$?
+    [ "$status" -eq "$2" ] || fail "$3 exited with $status instead of $2"
+}
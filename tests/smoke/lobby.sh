@@ -0,0 +1,22 @@
+#!/bin/bash
+# Second client for W waits in lobby, takes the seat once first W leaves and finishes the game.
+source "$(dirname "$0")/lib.sh"
+
+PORT=$(free_port)
+timeout $LIMIT "$SERVER" -f "$GAME" -p "$PORT" -t 2 -l > "$WORK/server.log" 2>&1 &
+SERVER_PID=$!
+wait_for_port "$PORT"
+
+$PLAYER -p "$PORT" --seat W --leave-after 5 > "$WORK/W1.log" 2>&1 &
+wait_for_log server.log IAMW
+$PLAYER -p "$PORT" --seat W > "$WORK/W2.log" 2>&1 &
+wait_for_log server.log QUEUE1
+start_clients "$PORT" N E S
+
+expect_exit $SERVER_PID 0 server
+wait
+expect_total N.log E.log S.log W2.log
+expect_field W1.log TAKEN 5
+expect_field W2.log QUEUE 1
+expect_field W2.log BUSY 0
+pass
@@ -0,0 +1,20 @@
+#!/bin/bash
+# W leaves in the middle of a hand, rejoins, catches up with DEAL and TAKEN and plays to the end.
+source "$(dirname "$0")/lib.sh"
+
+PORT=$(free_port)
+timeout $LIMIT "$SERVER" -f "$GAME" -p "$PORT" -t 2 > "$WORK/server.log" 2>&1 &
+SERVER_PID=$!
+wait_for_port "$PORT"
+
+start_clients "$PORT" N E S
+$PLAYER -p "$PORT" --seat W --leave-after 7 --rejoin-after 0.2 > "$WORK/W.log" 2>&1
+
+expect_exit $SERVER_PID 0 server
+wait
+expect_total N.log E.log S.log W.log
+expect_field W.log connections 2
+# Catch-up repeats DEAL and 7 TAKEN of the hand W left in.
+expect_field W.log DEAL 3
+expect_field W.log TAKEN 33
+pass
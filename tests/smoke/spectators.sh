@@ -0,0 +1,32 @@
+#!/bin/bash
+# Spectator watching from the start gets every event once, also TRICK sent again after timeout.
+# Spectator coming in the middle of second hand catches up from the start of that hand.
+source "$(dirname "$0")/lib.sh"
+
+PORT=$(free_port)
+timeout $LIMIT "$SERVER" -f "$GAME" -p "$PORT" -t 1 -s > "$WORK/server.log" 2>&1 &
+SERVER_PID=$!
+wait_for_port "$PORT"
+
+$PLAYER -p "$PORT" --spectate > "$WORK/early.log" 2>&1 &
+wait_for_log server.log SPECTATE
+$PLAYER -p "$PORT" --seat W --ignore-after 3 --pause-after 16 --pause-file "$WORK/paused" \
+    --resume-file "$WORK/resume" > "$WORK/W.log" 2>&1 &
+start_clients "$PORT" N E S
+
+wait_for_file "$WORK/paused"
+$PLAYER -p "$PORT" --spectate > "$WORK/late.log" 2>&1 &
+wait_for_log server.log SPECTATE 2
+touch "$WORK/resume"
+
+expect_exit $SERVER_PID 0 server
+wait
+expect_total N.log E.log S.log W.log
+expect_field W.log TRICK 27
+for field in DEAL=8 TRICK=104 TAKEN=26 SCORE=2 TOTAL=2 last="$EXPECTED_TOTAL"; do
+    expect_field early.log "${field%%=*}" "${field#*=}"
+done
+for field in DEAL=4 TRICK=52 TAKEN=13 SCORE=1 TOTAL=1 last="$EXPECTED_TOTAL"; do
+    expect_field late.log "${field%%=*}" "${field#*=}"
+done
+pass
@@ -0,0 +1,37 @@
+#!/bin/bash
+# New server process takes game over from running one while a spectator watches and a client
+# waits in lobby. Lobby client is seated by new process and spectator gets every event once.
+source "$(dirname "$0")/lib.sh"
+
+PORT=$(free_port)
+UPGRADE="$WORK/upgrade.sock"
+OPTIONS=(-f "$GAME" -p "$PORT" -t 5 -l -s -u "$UPGRADE")
+timeout $LIMIT "$SERVER" "${OPTIONS[@]}" > "$WORK/server.log" 2>&1 &
+OLD_PID=$!
+wait_for_port "$PORT"
+
+$PLAYER -p "$PORT" --spectate > "$WORK/spectator.log" 2>&1 &
+wait_for_log server.log SPECTATE
+$PLAYER -p "$PORT" --seat W --pause-after 8 --leave-after 10 --pause-file "$WORK/paused" \
+    --resume-file "$WORK/resume" > "$WORK/W1.log" 2>&1 &
+wait_for_log server.log IAMW
+$PLAYER -p "$PORT" --seat W > "$WORK/W2.log" 2>&1 &
+wait_for_log server.log QUEUE1
+start_clients "$PORT" N E S
+
+wait_for_file "$WORK/paused"
+timeout $LIMIT "$SERVER" "${OPTIONS[@]}" > "$WORK/server2.log" 2>&1 &
+NEW_PID=$!
+expect_exit $OLD_PID 0 "old server"
+grep -q "Took over game" "$WORK/server2.log" || fail "new server did not take game over"
+touch "$WORK/resume"
+
+expect_exit $NEW_PID 0 "new server"
+wait
+expect_total N.log E.log S.log W2.log
+expect_field W1.log TAKEN 10
+expect_field W2.log QUEUE 1
+for field in DEAL=8 TRICK=104 TAKEN=26 SCORE=2 TOTAL=2 last="$EXPECTED_TOTAL"; do
+    expect_field spectator.log "${field%%=*}" "${field#*=}"
+done
+pass
@@ -0,0 +1,30 @@
+#!/bin/bash
+# A successor connects to the upgrade socket and never confirms. The running server gives up
+# after the handover timeout and plays the whole game.
+source "$(dirname "$0")/lib.sh"
+
+PORT=$(free_port)
+timeout $LIMIT "$SERVER" -f "$GAME" -p "$PORT" -t 5 -u "$WORK/upgrade.sock" \
+    > "$WORK/server.log" 2>&1 &
+SERVER_PID=$!
+wait_for_port "$PORT"
+
+# Stalled successor reads nothing and holds the connection until the check ends.
+python3 - "$WORK/upgrade.sock" <<'PYTHON' > "$WORK/successor.log" 2>&1 &
+import socket, sys, time
+sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+sock.connect(sys.argv[1])
+print("connected", flush=True)
+time.sleep(60)
+PYTHON
+SUCCESSOR_PID=$!
+wait_for_log successor.log connected
+wait_for_log server.log "upgrade failed"
+
+start_clients "$PORT" N E S W
+expect_exit $SERVER_PID 0 "server"
+kill $SUCCESSOR_PID
+wait
+
+expect_total N.log E.log S.log W.log
+pass